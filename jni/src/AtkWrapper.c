@@ -215,7 +215,14 @@ enum _SignalType {
   Sig_Object_Property_Change_Accessible_Table_Row_Header = 18,
   Sig_Object_Property_Change_Accessible_Table_Row_Description = 19,
   Sig_Table_Model_Changed = 20,
-  Sig_Text_Property_Changed = 21
+  Sig_Text_Property_Changed = 21,
+  Sig_Text_Attributes_Changed = 22,
+  Sig_Table_Row_Inserted = 23,
+  Sig_Table_Row_Deleted = 24,
+  Sig_Table_Row_Reordered = 25,
+  Sig_Table_Column_Inserted = 26,
+  Sig_Table_Column_Deleted = 27,
+  Sig_Table_Cells_Changed = 28
 };
 
 typedef struct _CallbackPara {
@@ -228,6 +235,10 @@ typedef struct _CallbackPara {
   jobjectArray args;
   AtkStateType atk_state;
   gboolean state_value;
+  gint text_position;
+  gint text_length;
+  gint text_count;
+  jint text_serial;
 } CallbackPara;
 
 static CallbackPara*
@@ -326,6 +337,7 @@ focus_notify_handler (gpointer p)
   CallbackPara *para = (CallbackPara*)p;
 
   AtkObject* atk_obj = ATK_OBJECT(para->jaw_impl);
+  jaw_object_clear_read_ahead(JAW_OBJECT(atk_obj));
   atk_object_notify_state_change(atk_obj,
                                  ATK_STATE_FOCUSED,
                                  1);
@@ -401,6 +413,8 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowOpen(JNIEnv *jniEnv,
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_hierarchy_changed();
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   para->is_toplevel = jIsToplevel;
@@ -456,6 +470,7 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowClose(JNIEnv *jniEnv,
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   para->is_toplevel = jIsToplevel;
@@ -469,6 +484,7 @@ window_minimize_handler (gpointer p)
   CallbackPara *para = (CallbackPara*)p;
   AtkObject* atk_obj = ATK_OBJECT(para->jaw_impl);
 
+  jaw_component_invalidate_window_origin(JAW_OBJECT(atk_obj));
   g_signal_emit_by_name(atk_obj, "minimize");
 
   queue_free_callback_para(para);
@@ -486,6 +502,7 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowMinimize(JNIEnv *jniEnv,
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   jni_main_idle_add(window_minimize_handler, para);
@@ -498,6 +515,7 @@ window_maximize_handler (gpointer p)
   CallbackPara *para = (CallbackPara*)p;
   AtkObject* atk_obj = ATK_OBJECT(para->jaw_impl);
 
+  jaw_component_invalidate_window_origin(JAW_OBJECT(atk_obj));
   g_signal_emit_by_name(atk_obj, "maximize");
 
   queue_free_callback_para(para);
@@ -514,6 +532,7 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowMaximize(JN
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext );
   jni_main_idle_add(window_maximize_handler, para);
@@ -526,6 +545,7 @@ window_restore_handler (gpointer p)
   CallbackPara *para = (CallbackPara*)p;
   AtkObject* atk_obj = ATK_OBJECT(para->jaw_impl);
 
+  jaw_component_invalidate_window_origin(JAW_OBJECT(atk_obj));
   g_signal_emit_by_name(atk_obj, "restore");
 
   queue_free_callback_para(para);
@@ -542,6 +562,7 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowRestore(JNI
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   jni_main_idle_add(window_restore_handler, para);
@@ -611,6 +632,7 @@ window_state_change_handler (gpointer p)
   CallbackPara *para = (CallbackPara*)p;
   AtkObject* atk_obj = ATK_OBJECT(para->jaw_impl);
 
+  jaw_component_invalidate_window_origin(JAW_OBJECT(atk_obj));
   g_signal_emit_by_name(atk_obj, "state-change", 0, 0);
 
   queue_free_callback_para(para);
@@ -628,6 +650,7 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowStateChange(JNIEnv *jniEnv
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   jni_main_idle_add(window_state_change_handler, para);
@@ -651,6 +674,83 @@ get_int_value (JNIEnv *jniEnv, jobject o)
 static pthread_mutex_t jaw_vdc_dup_mutex = PTHREAD_MUTEX_INITIALIZER;
 static jobject jaw_vdc_last_ac = NULL;
 
+/*
+ * Likewise, a log area being appended to or a key held down sends one text
+ * insertion or deletion after the other.  As long as the previous one hasn't
+ * been sent and nothing else came in between, an adjacent one is merged
+ * into it, so that ATs get a single change for the whole batch.  Caret and
+ * visible data changes of the same object don't prevent merging.
+ */
+static pthread_mutex_t jaw_text_change_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CallbackPara *jaw_text_change_last = NULL;
+
+static gboolean
+jaw_text_change_merge (JNIEnv *jniEnv,
+                       jobject jAccContext,
+                       SignalType id,
+                       gint position,
+                       gint length,
+                       gint count,
+                       jint serial)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %d, %d, %d", jniEnv, jAccContext, id, position, length, count, serial);
+  gboolean merged = FALSE;
+
+  pthread_mutex_lock(&jaw_text_change_mutex);
+  CallbackPara *last = jaw_text_change_last;
+  if (last != NULL && last->signal_id == id &&
+      (*jniEnv)->IsSameObject(jniEnv, last->global_ac, jAccContext))
+  {
+    if (id == Sig_Text_Property_Changed_Insert)
+    {
+      /* Appended to the previous insertion, or inserted before it */
+      if (position == last->text_position + last->text_length ||
+          position == last->text_position)
+      {
+        last->text_length += length;
+        merged = TRUE;
+      }
+    }
+    else
+    {
+      /* Deleted before the previous deletion, or at the same place */
+      if (position + length == last->text_position)
+      {
+        last->text_position = position;
+        last->text_length += length;
+        merged = TRUE;
+      }
+      else if (position == last->text_position)
+      {
+        last->text_length += length;
+        merged = TRUE;
+      }
+    }
+
+    if (merged)
+    {
+      last->text_count = count;
+      last->text_serial = serial;
+    }
+  }
+  pthread_mutex_unlock(&jaw_text_change_mutex);
+
+  return merged;
+}
+
+static void
+jaw_text_change_break (JNIEnv *jniEnv, jobject jAccContext, SignalType id)
+{
+  JAW_DEBUG_C("%p, %p, %d", jniEnv, jAccContext, id);
+  pthread_mutex_lock(&jaw_text_change_mutex);
+  CallbackPara *last = jaw_text_change_last;
+  if (last != NULL &&
+      !((id == Sig_Text_Caret_Moved || id == Sig_Object_Visible_Data_Changed) &&
+        (*jniEnv)->IsSameObject(jniEnv, last->global_ac, jAccContext)))
+    jaw_text_change_last = NULL;
+  pthread_mutex_unlock(&jaw_text_change_mutex);
+}
+
 static gboolean
 signal_emit_handler (gpointer p)
 {
@@ -676,35 +776,49 @@ signal_emit_handler (gpointer p)
     {
       gint cursor_pos = get_int_value(jniEnv,
                                       (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+      jint serial = get_int_value(jniEnv,
+                                  (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      jaw_text_caret_moved(JAW_OBJECT(atk_obj), cursor_pos, serial);
       g_signal_emit_by_name(atk_obj, "text_caret_moved", cursor_pos);
       break;
     }
     case Sig_Text_Property_Changed_Insert:
-    {
-      gint insert_position = get_int_value(jniEnv,
-                                           (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-      gint insert_length = get_int_value(jniEnv,
-                                         (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
-      g_signal_emit_by_name(atk_obj,
-                            "text_changed::insert",
-                            insert_position,
-                            insert_length);
-      break;
-    }
     case Sig_Text_Property_Changed_Delete:
     {
-      gint delete_position = get_int_value(jniEnv,
-                                           (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-      gint delete_length = get_int_value(jniEnv,
-                                         (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      /* No more merging into this one once it is being sent */
+      pthread_mutex_lock(&jaw_text_change_mutex);
+      if (jaw_text_change_last == para)
+        jaw_text_change_last = NULL;
+      gint position = para->text_position;
+      gint length = para->text_length;
+      gint count = para->text_count;
+      jint serial = para->text_serial;
+      pthread_mutex_unlock(&jaw_text_change_mutex);
+
+      if (ATK_IS_TEXT(atk_obj))
+      {
+        JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+        jaw_text_count_changed(jaw_obj, count, serial);
+        jaw_hypertext_invalidate(jaw_obj);
+        /* So that a TEXT_PROPERTY_CHANGED for the same edit finds no change */
+        g_hash_table_insert(jaw_obj->storedData,
+                            (gpointer) "Previous_Count",
+                            GINT_TO_POINTER(atk_text_get_character_count(ATK_TEXT(jaw_obj))));
+      }
+
       g_signal_emit_by_name(atk_obj,
-                            "text_changed::delete",
-                            delete_position,
-                            delete_length);
+                            para->signal_id == Sig_Text_Property_Changed_Insert ?
+                            "text_changed::insert" : "text_changed::delete",
+                            position,
+                            length);
       break;
     }
     case Sig_Object_Children_Changed_Add:
     {
+      jaw_impl_flush_cells(jniEnv, para->jaw_impl);
+      jaw_table_invalidate(JAW_OBJECT(atk_obj),
+                           JAW_TABLE_N_ROWS | JAW_TABLE_N_COLUMNS | JAW_TABLE_SELECTED_ROWS);
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
       gint child_index = get_int_value(jniEnv,
                                        (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
       g_signal_emit_by_name(atk_obj,
@@ -715,6 +829,10 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Children_Changed_Remove:
     {
+      jaw_impl_flush_cells(jniEnv, para->jaw_impl);
+      jaw_table_invalidate(JAW_OBJECT(atk_obj),
+                           JAW_TABLE_N_ROWS | JAW_TABLE_N_COLUMNS | JAW_TABLE_SELECTED_ROWS);
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
       gint child_index = get_int_value(jniEnv,
                                        (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
 
@@ -733,12 +851,28 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Selection_Changed:
     {
+      /* The states read ahead with the cells have SELECTED in them */
+      jaw_object_drop_read_ahead();
+      jaw_impl_flush_selected_cells(jniEnv, para->jaw_impl);
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_SELECTED_ROWS);
       g_signal_emit_by_name(atk_obj,
                             "selection_changed");
       break;
     }
     case Sig_Object_Visible_Data_Changed:
     {
+      /*
+       * Lists send this rather than children changes when items come and go,
+       * and trees when nodes are inserted or removed, so the pooled children
+       * may now be at other indexes.  Tables tell what changed instead, but
+       * the names and states read ahead with their rows may be stale.
+       */
+      if (!ATK_IS_TABLE(atk_obj))
+        jaw_impl_flush_cells(jniEnv, para->jaw_impl);
+      else
+        jaw_object_drop_read_ahead();
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
       g_signal_emit_by_name(atk_obj,
                             "visible_data_changed");
       break;
@@ -785,11 +919,13 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Name:
     {
+      jaw_object_clear_read_ahead(JAW_OBJECT(atk_obj));
       g_object_notify(G_OBJECT(atk_obj), "accessible-name");
       break;
      }
     case Sig_Object_Property_Change_Accessible_Hypertext_Offset:
     {
+      jaw_hypertext_invalidate(JAW_OBJECT(atk_obj));
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-hypertext-offset",
                             NULL);
@@ -797,6 +933,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Caption:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_CAPTION);
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-table-caption",
                             NULL);
@@ -804,6 +941,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Summary:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_SUMMARY);
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-table-summary",
                             NULL);
@@ -811,6 +949,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Column_Header:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_COLUMN_HEADER);
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-table-column-header",
                             NULL);
@@ -818,6 +957,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Column_Description:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_COLUMN_DESCRIPTION);
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-table-column-description",
                             NULL);
@@ -825,6 +965,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Row_Header:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_ROW_HEADER);
       g_signal_emit_by_name(atk_obj,
       "property_change::accessible-table-row-header",
       NULL);
@@ -832,6 +973,7 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Object_Property_Change_Accessible_Table_Row_Description:
     {
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_ROW_DESCRIPTION);
       g_signal_emit_by_name(atk_obj,
                             "property_change::accessible-table-row-description",
                             NULL);
@@ -839,6 +981,9 @@ signal_emit_handler (gpointer p)
     }
     case Sig_Table_Model_Changed:
     {
+      jaw_impl_flush_cells(jniEnv, para->jaw_impl);
+      jaw_table_invalidate(JAW_OBJECT(atk_obj), JAW_TABLE_ALL);
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
       g_signal_emit_by_name(atk_obj,
                             "model_changed");
       break;
@@ -847,8 +992,13 @@ signal_emit_handler (gpointer p)
     {
       JawObject * jaw_obj = JAW_OBJECT(atk_obj);
 
-      gint newValue = get_int_value(jniEnv,
-                                    (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+      gint count = get_int_value(jniEnv,
+                                 (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      jint serial = get_int_value(jniEnv,
+                                  (*jniEnv)->GetObjectArrayElement(jniEnv, args, 2));
+      /* Lets the count below come from the cache */
+      jaw_text_count_changed(jaw_obj, count, serial);
+      jaw_hypertext_invalidate(jaw_obj);
 
       gint prevCount = GPOINTER_TO_INT(g_hash_table_lookup(jaw_obj->storedData,
                                                            "Previous_Count"));
@@ -858,22 +1008,101 @@ signal_emit_handler (gpointer p)
                           (gpointer) "Previous_Count",
                           GINT_TO_POINTER(curCount));
 
-      if (curCount > prevCount)
+      /* Only where the change starts is known, so the whole text is replaced */
+      if (prevCount > 0)
       {
         g_signal_emit_by_name(atk_obj,
-                              "text_changed::insert",
-                              newValue,
-                              curCount - prevCount);
+                              "text_changed::delete",
+                              0,
+                              prevCount);
       }
-      else if (curCount < prevCount)
+      if (curCount > 0)
       {
         g_signal_emit_by_name(atk_obj,
-                              "text_changed::delete",
-                              newValue,
-                              prevCount - curCount);
+                              "text_changed::insert",
+                              0,
+                              curCount);
       }
       break;
     }
+    case Sig_Text_Attributes_Changed:
+    {
+      /* Links are attributes of the text */
+      jaw_hypertext_invalidate(JAW_OBJECT(atk_obj));
+      g_signal_emit_by_name(atk_obj,
+                            "text_attributes_changed");
+      break;
+    }
+    case Sig_Table_Row_Inserted:
+    case Sig_Table_Row_Deleted:
+    {
+      gint row = get_int_value(jniEnv,
+                               (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+      gint n = get_int_value(jniEnv,
+                             (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      gboolean inserted = para->signal_id == Sig_Table_Row_Inserted;
+
+      /* The rows above keep their cells */
+      jaw_impl_flush_cell_range(jniEnv, para->jaw_impl, row, G_MAXINT, 0, G_MAXINT);
+      jaw_impl_flush_selected_cells(jniEnv, para->jaw_impl);
+      jaw_table_shift_rows(JAW_OBJECT(atk_obj), row, inserted ? n : -n);
+      g_signal_emit_by_name(atk_obj,
+                            inserted ? "row_inserted" : "row_deleted",
+                            row,
+                            n);
+      break;
+    }
+    case Sig_Table_Column_Inserted:
+    case Sig_Table_Column_Deleted:
+    {
+      gint column = get_int_value(jniEnv,
+                                  (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+      gint n = get_int_value(jniEnv,
+                             (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      gboolean inserted = para->signal_id == Sig_Table_Column_Inserted;
+
+      jaw_impl_flush_cell_range(jniEnv, para->jaw_impl, 0, G_MAXINT, column, G_MAXINT);
+      jaw_impl_flush_selected_cells(jniEnv, para->jaw_impl);
+      jaw_table_shift_columns(JAW_OBJECT(atk_obj), column, inserted ? n : -n);
+      g_signal_emit_by_name(atk_obj,
+                            inserted ? "column_inserted" : "column_deleted",
+                            column,
+                            n);
+      break;
+    }
+    case Sig_Table_Row_Reordered:
+    {
+      gint n_rows = get_int_value(jniEnv,
+                                  (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+
+      jaw_impl_flush_cells(jniEnv, para->jaw_impl);
+      jaw_selection_invalidate(JAW_OBJECT(atk_obj));
+      if (jaw_table_reorder_rows(JAW_OBJECT(atk_obj), n_rows))
+        g_signal_emit_by_name(atk_obj,
+                              "row_reordered");
+      else
+        g_signal_emit_by_name(atk_obj,
+                              "model_changed");
+      break;
+    }
+    case Sig_Table_Cells_Changed:
+    {
+      gint first_row = get_int_value(jniEnv,
+                                     (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+      gint last_row = get_int_value(jniEnv,
+                                    (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+      gint first_column = get_int_value(jniEnv,
+                                        (*jniEnv)->GetObjectArrayElement(jniEnv, args, 2));
+      gint last_column = get_int_value(jniEnv,
+                                       (*jniEnv)->GetObjectArrayElement(jniEnv, args, 3));
+
+      /* Swing already sent visible_data_changed for these */
+      jaw_impl_flush_cell_range(jniEnv, para->jaw_impl,
+                                first_row, last_row, first_column, last_column);
+      jaw_table_update_cells(JAW_OBJECT(atk_obj),
+                             first_row, last_row, first_column, last_column);
+      break;
+    }
     case Sig_Text_Property_Changed_Replace:
       // TODO
     default:
@@ -918,17 +1147,64 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal(JNIEnv *jniEnv,
     return;
   }
 
+  switch (id)
+  {
+    case Sig_Object_Children_Changed_Add:
+    case Sig_Object_Children_Changed_Remove:
+      jaw_component_hierarchy_changed();
+      jaw_component_layout_changed();
+      break;
+    case Sig_Object_Visible_Data_Changed:
+    case Sig_Table_Model_Changed:
+    case Sig_Table_Row_Inserted:
+    case Sig_Table_Row_Deleted:
+    case Sig_Table_Row_Reordered:
+    case Sig_Table_Column_Inserted:
+    case Sig_Table_Column_Deleted:
+      jaw_component_layout_changed();
+      break;
+    default:
+      break;
+  }
+
+  gint text_position = 0, text_length = 0, text_count = 0;
+  jint text_serial = 0;
+  if (id == Sig_Text_Property_Changed_Insert || id == Sig_Text_Property_Changed_Delete)
+  {
+    text_position = get_int_value(jniEnv, (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
+    text_length = get_int_value(jniEnv, (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
+    text_count = get_int_value(jniEnv, (*jniEnv)->GetObjectArrayElement(jniEnv, args, 2));
+    text_serial = get_int_value(jniEnv, (*jniEnv)->GetObjectArrayElement(jniEnv, args, 3));
+    if (jaw_text_change_merge(jniEnv, jAccContext, id, text_position, text_length,
+                              text_count, text_serial))
+      return;
+  }
+  else
+  {
+    jaw_text_change_break(jniEnv, jAccContext, id);
+  }
+
   callback_para_process_frees();
   jobjectArray global_args = (jobjectArray)(*jniEnv)->NewGlobalRef(jniEnv, args);
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   para->ac = jAccContext;
   para->signal_id = (gint)id;
   para->args = global_args;
+  para->text_position = text_position;
+  para->text_length = text_length;
+  para->text_count = text_count;
+  para->text_serial = text_serial;
   switch (para->signal_id)
   {
-    case Sig_Text_Caret_Moved:
     case Sig_Text_Property_Changed_Insert:
     case Sig_Text_Property_Changed_Delete:
+    {
+      pthread_mutex_lock(&jaw_text_change_mutex);
+      jaw_text_change_last = para;
+      pthread_mutex_unlock(&jaw_text_change_mutex);
+      break;
+    }
+    case Sig_Text_Caret_Moved:
     case Sig_Text_Property_Changed_Replace:
     case Sig_Object_Selection_Changed:
     case Sig_Object_Visible_Data_Changed:
@@ -945,6 +1221,13 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal(JNIEnv *jniEnv,
     case Sig_Object_Property_Change_Accessible_Table_Row_Description:
     case Sig_Table_Model_Changed:
     case Sig_Text_Property_Changed:
+    case Sig_Text_Attributes_Changed:
+    case Sig_Table_Row_Inserted:
+    case Sig_Table_Row_Deleted:
+    case Sig_Table_Row_Reordered:
+    case Sig_Table_Column_Inserted:
+    case Sig_Table_Column_Deleted:
+    case Sig_Table_Cells_Changed:
     default:
       break;
     case Sig_Object_Children_Changed_Add:
@@ -993,12 +1276,31 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal(JNIEnv *jniEnv,
   jni_main_idle_add(signal_emit_handler, para);
 }
 
+JNIEXPORT void
+JNICALL Java_org_GNOME_Accessibility_AtkWrapper_textMirrorChanged(JNIEnv *jniEnv,
+                                                                  jclass jClass,
+                                                                  jobject jAtkText,
+                                                                  jint position,
+                                                                  jint deleted,
+                                                                  jstring jInserted,
+                                                                  jint count)
+{
+  JAW_DEBUG_JNI("%p, %p, %p, %d, %d, %p, %d", jniEnv, jClass, jAtkText, position, deleted, jInserted, count);
+  if (!jAtkText) {
+    JAW_DEBUG_I("jAtkText == NULL");
+    return;
+  }
+
+  jaw_text_mirror_changed(jniEnv, jAtkText, position, deleted, jInserted, count);
+}
+
 static gboolean
 object_state_change_handler (gpointer p)
 {
   JAW_DEBUG_C("%p", p);
   CallbackPara *para = (CallbackPara*)p;
 
+  jaw_object_clear_read_ahead(JAW_OBJECT(para->jaw_impl));
   atk_object_notify_state_change(ATK_OBJECT(para->jaw_impl),
                                  para->atk_state,
                                  para->state_value);
@@ -1024,6 +1326,8 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_objectStateChange(JNIEnv *jniEnv
   AtkStateType state_type = jaw_util_get_atk_state_type_from_java_state( jniEnv, state );
   para->atk_state = state_type;
   para->state_value = value;
+  if (state_type == ATK_STATE_VISIBLE || state_type == ATK_STATE_SHOWING)
+    jaw_component_layout_changed();
   jni_main_idle_add(object_state_change_handler, para);
 }
 
@@ -1055,6 +1359,7 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_componentAdded(JNIEnv *jniEnv,
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   jni_main_idle_add(component_added_handler, para);
@@ -1090,6 +1395,7 @@ JNICALL Java_org_GNOME_Accessibility_AtkWrapper_componentRemoved(JNIEnv *jniEnv,
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
   jni_main_idle_add(component_removed_handler, para);
@@ -1116,7 +1422,27 @@ bounds_changed_handler (gpointer p)
   rect.y = -1;
   rect.width = -1;
   rect.height = -1;
+  jaw_component_invalidate_window_origin(JAW_OBJECT(atk_obj));
   g_signal_emit_by_name(atk_obj, "bounds_changed", &rect);
+
+  /*
+   * The components laid out again with it only get the signal when an AT
+   * asked for their extents, others would not notice the difference.
+   */
+  if (para->args != NULL)
+  {
+    JNIEnv *jniEnv = jaw_util_get_jni_env();
+    jsize n = (*jniEnv)->GetArrayLength(jniEnv, para->args);
+    jsize i;
+    for (i = 0; i < n; i++)
+    {
+      jobject jdescendant = (*jniEnv)->GetObjectArrayElement(jniEnv, para->args, i);
+      JawImpl *descendant = jaw_impl_find_instance(jniEnv, jdescendant);
+      (*jniEnv)->DeleteLocalRef(jniEnv, jdescendant);
+      if (descendant != NULL && jaw_component_extents_queried(JAW_OBJECT(descendant)))
+        g_signal_emit_by_name(ATK_OBJECT(descendant), "bounds_changed", &rect);
+    }
+  }
   queue_free_callback_para(para);
 
   return G_SOURCE_REMOVE;
@@ -1125,15 +1451,21 @@ bounds_changed_handler (gpointer p)
 JNIEXPORT void
 JNICALL Java_org_GNOME_Accessibility_AtkWrapper_boundsChanged(JNIEnv *jniEnv,
                                                               jclass jClass,
-                                                              jobject jAccContext)
+                                                              jobject jAccContext,
+                                                              jobjectArray jDescendants)
 {
-  JAW_DEBUG_JNI("%p, %p, %p", jniEnv, jClass, jAccContext);
+  JAW_DEBUG_JNI("%p, %p, %p, %p", jniEnv, jClass, jAccContext, jDescendants);
   if (!jAccContext) {
     JAW_DEBUG_I("jAccContext == NULL");
     return;
   }
+  jaw_component_layout_changed();
   callback_para_process_frees();
   CallbackPara *para = alloc_callback_para(jniEnv, jAccContext);
+  if (para == NULL)
+    return;
+  if (jDescendants != NULL && (*jniEnv)->GetArrayLength(jniEnv, jDescendants) > 0)
+    para->args = (*jniEnv)->NewGlobalRef(jniEnv, jDescendants);
   jni_main_idle_add(bounds_changed_handler, para);
 }
 
@@ -108,6 +108,14 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowStateChange
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal
   (JNIEnv *, jclass, jobject, jint, jobjectArray);
 
+/*
+ * Class:     org_GNOME_Accessibility_AtkWrapper
+ * Method:    textMirrorChanged
+ * Signature: (Lorg/GNOME/Accessibility/AtkText;IILjava/lang/String;I)V
+ */
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_textMirrorChanged
+  (JNIEnv *, jclass, jobject, jint, jint, jstring, jint);
+
 /*
  * Class:     org_GNOME_Accessibility_AtkWrapper
  * Method:    objectStateChange
@@ -135,10 +143,10 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_componentRemoved
 /*
  * Class:     org_GNOME_Accessibility_AtkWrapper
  * Method:    boundsChanged
- * Signature: (Ljavax/accessibility/AccessibleContext;)V
+ * Signature: (Ljavax/accessibility/AccessibleContext;[Ljavax/accessibility/AccessibleContext;)V
  */
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_boundsChanged
-  (JNIEnv *, jclass, jobject);
+  (JNIEnv *, jclass, jobject, jobjectArray);
 
 /*
  * Class:     org_GNOME_Accessibility_AtkWrapper
@@ -0,0 +1,191 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include "jawutil.h"
+#include "jawcellpool.h"
+
+typedef struct _JawCell {
+  gint row;
+  gint column;
+  JawImpl *jaw_impl;
+  jobject ac;
+} JawCell;
+
+struct _JawCellPool {
+  /* JawCell keys to their link in lru, most recently used first */
+  GHashTable *cells;
+  GQueue lru;
+  guint max_size;
+};
+
+static guint
+jaw_cell_hash (gconstpointer p)
+{
+  const JawCell *cell = p;
+  return (guint)cell->row * 31u + (guint)cell->column;
+}
+
+static gboolean
+jaw_cell_equal (gconstpointer a, gconstpointer b)
+{
+  const JawCell *cell_a = a;
+  const JawCell *cell_b = b;
+  return cell_a->row == cell_b->row && cell_a->column == cell_b->column;
+}
+
+static void
+jaw_cell_free (JNIEnv *jniEnv, JawCell *cell)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, cell);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, cell->ac);
+  g_object_unref(G_OBJECT(cell->jaw_impl));
+  g_free(cell);
+}
+
+JawCellPool*
+jaw_cell_pool_new (guint max_size)
+{
+  JAW_DEBUG_C("%u", max_size);
+  JawCellPool *pool = g_new0(JawCellPool, 1);
+  pool->cells = g_hash_table_new(jaw_cell_hash, jaw_cell_equal);
+  g_queue_init(&pool->lru);
+  pool->max_size = max_size;
+  return pool;
+}
+
+void
+jaw_cell_pool_free (JNIEnv *jniEnv, JawCellPool *pool)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, pool);
+  if (pool == NULL)
+    return;
+
+  jaw_cell_pool_clear(jniEnv, pool);
+  g_hash_table_destroy(pool->cells);
+  g_free(pool);
+}
+
+static void
+jaw_cell_pool_remove_link (JNIEnv *jniEnv, JawCellPool *pool, GList *link)
+{
+  JawCell *cell = link->data;
+  g_hash_table_remove(pool->cells, cell);
+  g_queue_delete_link(&pool->lru, link);
+  jaw_cell_free(jniEnv, cell);
+}
+
+/* The JawImpl of the cell if it is in the pool, without a new reference */
+JawImpl*
+jaw_cell_pool_lookup (JawCellPool *pool, gint row, gint column)
+{
+  JAW_DEBUG_C("%p, %d, %d", pool, row, column);
+  JawCell key = { row, column, NULL, NULL };
+  GList *link = g_hash_table_lookup(pool->cells, &key);
+  if (link == NULL)
+    return NULL;
+
+  g_queue_unlink(&pool->lru, link);
+  g_queue_push_head_link(&pool->lru, link);
+  return ((JawCell*)link->data)->jaw_impl;
+}
+
+/* Keep jaw_impl and ac for the cell, dropping the least recently used one */
+void
+jaw_cell_pool_insert (JNIEnv *jniEnv,
+                      JawCellPool *pool,
+                      gint row,
+                      gint column,
+                      JawImpl *jaw_impl,
+                      jobject ac)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %p, %p", jniEnv, pool, row, column, jaw_impl, ac);
+  JawCell key = { row, column, NULL, NULL };
+  GList *link = g_hash_table_lookup(pool->cells, &key);
+  if (link != NULL)
+    jaw_cell_pool_remove_link(jniEnv, pool, link);
+
+  jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
+  if (global_ac == NULL)
+    return;
+
+  while (pool->lru.length >= pool->max_size && pool->lru.tail != NULL)
+    jaw_cell_pool_remove_link(jniEnv, pool, pool->lru.tail);
+
+  JawCell *cell = g_new(JawCell, 1);
+  cell->row = row;
+  cell->column = column;
+  cell->jaw_impl = g_object_ref(jaw_impl);
+  cell->ac = global_ac;
+  g_queue_push_head(&pool->lru, cell);
+  g_hash_table_insert(pool->cells, cell, pool->lru.head);
+}
+
+void
+jaw_cell_pool_remove_column (JNIEnv *jniEnv, JawCellPool *pool, gint column)
+{
+  JAW_DEBUG_C("%p, %p, %d", jniEnv, pool, column);
+  GList *link, *next;
+  for (link = pool->lru.head; link != NULL; link = next)
+  {
+    next = link->next;
+    if (((JawCell*)link->data)->column == column)
+      jaw_cell_pool_remove_link(jniEnv, pool, link);
+  }
+}
+
+/*
+ * Drop the cells of rows first_row to last_row and columns first_column to
+ * last_column, and the children kept by index since theirs moved too
+ */
+void
+jaw_cell_pool_remove_range (JNIEnv *jniEnv,
+                            JawCellPool *pool,
+                            gint first_row,
+                            gint last_row,
+                            gint first_column,
+                            gint last_column)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %d, %d", jniEnv, pool, first_row, last_row, first_column, last_column);
+  GList *link, *next;
+  for (link = pool->lru.head; link != NULL; link = next)
+  {
+    JawCell *cell = link->data;
+    next = link->next;
+    if (cell->column == JAW_CELL_POOL_CHILD ||
+        (cell->column >= first_column && cell->column <= last_column &&
+         cell->row >= first_row && cell->row <= last_row))
+      jaw_cell_pool_remove_link(jniEnv, pool, link);
+  }
+}
+
+void
+jaw_cell_pool_clear (JNIEnv *jniEnv, JawCellPool *pool)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, pool);
+  while (pool->lru.head != NULL)
+    jaw_cell_pool_remove_link(jniEnv, pool, pool->lru.head);
+}
+
+guint
+jaw_cell_pool_get_size (JawCellPool *pool)
+{
+  JAW_DEBUG_C("%p", pool);
+  return pool->lru.length;
+}
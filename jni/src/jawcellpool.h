@@ -0,0 +1,53 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_CELL_POOL_H_
+#define _JAW_CELL_POOL_H_
+
+#include <glib.h>
+#include <jni.h>
+#include "jawimpl.h"
+
+G_BEGIN_DECLS
+
+/*
+ * The most recently used cells of a container whose children are made up
+ * on demand, like the cells of a JTable, keyed by (row, column).  Each cell
+ * keeps a reference to its JawImpl and a global reference to its
+ * AccessibleContext, which would otherwise be collected right away.  It is
+ * only used from the jaw thread.
+ */
+typedef struct _JawCellPool		JawCellPool;
+
+/* Columns used for keys that are not table cells */
+#define JAW_CELL_POOL_CHILD		-1
+#define JAW_CELL_POOL_SELECTION		-2
+
+JawCellPool* jaw_cell_pool_new(guint);
+void jaw_cell_pool_free(JNIEnv*, JawCellPool*);
+
+JawImpl* jaw_cell_pool_lookup(JawCellPool*, gint, gint);
+void jaw_cell_pool_insert(JNIEnv*, JawCellPool*, gint, gint, JawImpl*, jobject);
+void jaw_cell_pool_remove_column(JNIEnv*, JawCellPool*, gint);
+void jaw_cell_pool_remove_range(JNIEnv*, JawCellPool*, gint, gint, gint, gint);
+void jaw_cell_pool_clear(JNIEnv*, JawCellPool*);
+guint jaw_cell_pool_get_size(JawCellPool*);
+
+G_END_DECLS
+
+#endif
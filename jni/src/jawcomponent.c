@@ -21,8 +21,10 @@
 #include <atk/atk.h>
 #include <glib.h>
 #include <glib-object.h>
+#include <stdint.h>
 #include "jawimpl.h"
 #include "jawutil.h"
+#include "jawhitgrid.h"
 
 static gboolean jaw_component_contains(AtkComponent *component,
                                        gint         x,
@@ -52,10 +54,67 @@ static gboolean jaw_component_grab_focus(AtkComponent *component);
 static AtkLayer jaw_component_get_layer(AtkComponent *component);
 /*static gin jaw_component_get_mdi_zorder(AtkComponent		*component); */
 
+/* A weak pointer, so that a kept layout doesn't keep its children alive */
+typedef struct _JawComponentChild {
+  JawImpl *jaw_impl;
+} JawComponentChild;
+
+/*
+ * Screen readers following the mouse ask each level of the hierarchy for
+ * the child at the same point, which costs a round trip to Swing and a walk
+ * up to the window per level.  So the first such request after the layout
+ * changed reads where all the children of the component are, and the next
+ * ones are answered from that in the jaw thread.  Points which hit no child
+ * are still asked to Java, as are tables, lists and trees, whose cells are
+ * made up at each request, and components with children which are not AWT
+ * Components, since nothing tells when those move.
+ */
 typedef struct _ComponentData {
   jobject atk_component;
+  gboolean layout_valid;
+  gint layout_serial;
+  /* x, y of the component for each AtkCoordType */
+  gint origins[6];
+  /* NULL when the children are not kept */
+  JawHitGrid *grid;
+  JawComponentChild *children;
+  gint n_children;
+  /*
+   * The window the component is in, looked up again when the hierarchy
+   * changed, and a weak pointer so that it can go away first.
+   */
+  gboolean window_checked;
+  gint window_serial;
+  JawImpl *window;
+  /* When the component is a window, its origin on the screen */
+  gboolean window_origin_valid;
+  gint window_origin_x;
+  gint window_origin_y;
+  /*
+   * The component whose layout last listed this one, as a weak pointer,
+   * and the index there, so that its extents are answered from there
+   * while that layout is current.  layout_parent_serial is the layout
+   * serial at which the parent layout was last asked for.
+   */
+  JawImpl *layout_parent;
+  gint layout_index;
+  gboolean layout_parent_checked;
+  gint layout_parent_serial;
+  /* Whether an AT asked for the extents, see bounds_changed_handler */
+  gboolean extents_queried;
 } ComponentData;
 
+/* Changed by jaw_component_layout_changed() from the application threads */
+static gint jaw_component_layout_serial = 0;
+/* Changed by jaw_component_hierarchy_changed() from the application threads */
+static gint jaw_component_hierarchy_serial = 0;
+/* Layout serial of the last extents not found in a layout, jaw thread only */
+static gint jaw_component_extents_miss_serial = -1;
+
+static void jaw_component_clear_layout(JNIEnv *jniEnv, ComponentData *data);
+static void jaw_component_set_window(ComponentData *data, JawImpl *window);
+static void jaw_component_set_layout_parent(ComponentData *data, JawImpl *parent, gint index);
+
 #define JAW_GET_COMPONENT(component, def_ret) \
   JAW_GET_OBJ_IFACE(component, INTERFACE_COMPONENT, ComponentData, atk_component, jniEnv, atk_component, def_ret)
 
@@ -110,16 +169,389 @@ jaw_component_data_finalize (gpointer p)
 
   if (data && data->atk_component)
   {
+    jaw_component_clear_layout(jniEnv, data);
+    jaw_component_set_window(data, NULL);
+    jaw_component_set_layout_parent(data, NULL, 0);
     (*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_component);
     data->atk_component = NULL;
   }
 }
 
+/*
+ * Called when anything may have moved, been shown or hidden, added or
+ * removed, so that every component reads its children again.
+ */
+void
+jaw_component_layout_changed (void)
+{
+  JAW_DEBUG_C("");
+  g_atomic_int_inc(&jaw_component_layout_serial);
+}
+
+/* Changes whenever jaw_component_layout_changed() is called */
+gint
+jaw_component_get_layout_serial (void)
+{
+  return g_atomic_int_get(&jaw_component_layout_serial);
+}
+
+/* Called when components may have moved to other windows */
+void
+jaw_component_hierarchy_changed (void)
+{
+  JAW_DEBUG_C("");
+  g_atomic_int_inc(&jaw_component_hierarchy_serial);
+}
+
+gboolean
+jaw_component_extents_queried (JawObject *jaw_obj)
+{
+  ComponentData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_COMPONENT);
+  return data != NULL && data->extents_queried;
+}
+
+/* Called when the window jaw_obj may have moved on the screen */
+void
+jaw_component_invalidate_window_origin (JawObject *jaw_obj)
+{
+  JAW_DEBUG_C("%p", jaw_obj);
+  if (jaw_obj == NULL)
+    return;
+
+  ComponentData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_COMPONENT);
+  if (data != NULL)
+    data->window_origin_valid = FALSE;
+}
+
+static void
+jaw_component_set_window (ComponentData *data, JawImpl *window)
+{
+  if (data->window != NULL)
+    g_object_remove_weak_pointer(G_OBJECT(data->window), (gpointer*)&data->window);
+  data->window = window;
+  if (data->window != NULL)
+    g_object_add_weak_pointer(G_OBJECT(data->window), (gpointer*)&data->window);
+}
+
+/*
+ * Origin on the screen of the window the component is in.  Both the window
+ * and its origin are kept, so that converting from and to WINDOW coordinates
+ * does not walk up the hierarchy each time.
+ */
+static gboolean
+jaw_component_get_window_origin (JNIEnv *jniEnv,
+                                 ComponentData *data,
+                                 jobject atk_component,
+                                 gint *x,
+                                 gint *y)
+{
+  JAW_DEBUG_C("%p, %p, %p, %p, %p", jniEnv, data, atk_component, x, y);
+  jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
+                                                  "org/GNOME/Accessibility/AtkComponent");
+  gint serial = g_atomic_int_get(&jaw_component_hierarchy_serial);
+
+  if (!data->window_checked || data->window_serial != serial)
+  {
+    jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                            classAtkComponent,
+                                            "get_window_instance",
+                                            "()J");
+    jlong jwindow = (*jniEnv)->CallLongMethod(jniEnv, atk_component, jmid);
+    jaw_component_set_window(data, (JawImpl*) (uintptr_t) jwindow);
+    data->window_checked = TRUE;
+    data->window_serial = serial;
+  }
+
+  if (data->window == NULL)
+    return FALSE;
+
+  ComponentData *window_data = jaw_object_get_interface_data(JAW_OBJECT(data->window),
+                                                             INTERFACE_COMPONENT);
+  if (window_data == NULL || window_data->atk_component == NULL)
+    return FALSE;
+
+  if (!window_data->window_origin_valid)
+  {
+    jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                            classAtkComponent,
+                                            "get_location_on_screen",
+                                            "()Ljava/awt/Point;");
+    jobject jpoint = (*jniEnv)->CallObjectMethod(jniEnv, window_data->atk_component, jmid);
+    if (jpoint == NULL)
+      return FALSE;
+
+    jclass classPoint = (*jniEnv)->FindClass(jniEnv, "java/awt/Point");
+    jfieldID jfidX = (*jniEnv)->GetFieldID(jniEnv, classPoint, "x", "I");
+    jfieldID jfidY = (*jniEnv)->GetFieldID(jniEnv, classPoint, "y", "I");
+    window_data->window_origin_x = (gint)(*jniEnv)->GetIntField(jniEnv, jpoint, jfidX);
+    window_data->window_origin_y = (gint)(*jniEnv)->GetIntField(jniEnv, jpoint, jfidY);
+    window_data->window_origin_valid = TRUE;
+    (*jniEnv)->DeleteLocalRef(jniEnv, jpoint);
+  }
+
+  *x = window_data->window_origin_x;
+  *y = window_data->window_origin_y;
+  return TRUE;
+}
+
+/* Turn WINDOW coordinates into SCREEN ones, which Java gets without a walk */
+static void
+jaw_component_window_to_screen (JNIEnv *jniEnv,
+                                ComponentData *data,
+                                jobject atk_component,
+                                gint *x,
+                                gint *y,
+                                AtkCoordType *coord_type)
+{
+  gint window_x, window_y;
+  if (*coord_type != ATK_XY_WINDOW ||
+      !jaw_component_get_window_origin(jniEnv, data, atk_component, &window_x, &window_y))
+    return;
+
+  *x += window_x;
+  *y += window_y;
+  *coord_type = ATK_XY_SCREEN;
+}
+
+static void
+jaw_component_clear_layout (JNIEnv *jniEnv, ComponentData *data)
+{
+  gint i;
+  for (i = 0; i < data->n_children; i++)
+  {
+    if (data->children[i].jaw_impl != NULL)
+      g_object_remove_weak_pointer(G_OBJECT(data->children[i].jaw_impl),
+                                   (gpointer*)&data->children[i].jaw_impl);
+  }
+  g_free(data->children);
+  data->children = NULL;
+  data->n_children = 0;
+  jaw_hit_grid_free(data->grid);
+  data->grid = NULL;
+  data->layout_valid = FALSE;
+}
+
+static void
+jaw_component_set_layout_parent (ComponentData *data, JawImpl *parent, gint index)
+{
+  if (data->layout_parent != NULL)
+    g_object_remove_weak_pointer(G_OBJECT(data->layout_parent),
+                                 (gpointer*)&data->layout_parent);
+  data->layout_parent = parent;
+  data->layout_index = index;
+  if (data->layout_parent != NULL)
+    g_object_add_weak_pointer(G_OBJECT(data->layout_parent),
+                              (gpointer*)&data->layout_parent);
+}
+
+static gboolean
+jaw_component_layout_is_current (ComponentData *data)
+{
+  return data->layout_valid &&
+         data->layout_serial == g_atomic_int_get(&jaw_component_layout_serial);
+}
+
+/* Keep the AtkComponent.ChildrenLayout jlayout as the layout of jaw_impl */
+static void
+jaw_component_set_layout (JNIEnv *jniEnv,
+                          JawImpl *jaw_impl,
+                          ComponentData *data,
+                          jobject jlayout)
+{
+  JAW_DEBUG_C("%p, %p, %p, %p", jniEnv, jaw_impl, data, jlayout);
+  jaw_component_clear_layout(jniEnv, data);
+  data->layout_valid = TRUE;
+  data->layout_serial = g_atomic_int_get(&jaw_component_layout_serial);
+
+  if (jlayout == NULL)
+    return;
+
+  jclass classLayout = (*jniEnv)->FindClass(jniEnv,
+                                            "org/GNOME/Accessibility/AtkComponent$ChildrenLayout");
+  jfieldID jfidOrigins = (*jniEnv)->GetFieldID(jniEnv, classLayout, "origins", "[I");
+  jfieldID jfidWidth = (*jniEnv)->GetFieldID(jniEnv, classLayout, "width", "I");
+  jfieldID jfidHeight = (*jniEnv)->GetFieldID(jniEnv, classLayout, "height", "I");
+  jfieldID jfidInstances = (*jniEnv)->GetFieldID(jniEnv, classLayout, "instances", "[J");
+  jfieldID jfidBounds = (*jniEnv)->GetFieldID(jniEnv, classLayout, "bounds", "[I");
+
+  jintArray jorigins = (*jniEnv)->GetObjectField(jniEnv, jlayout, jfidOrigins);
+  jlongArray jinstances = (*jniEnv)->GetObjectField(jniEnv, jlayout, jfidInstances);
+  jintArray jbounds = (*jniEnv)->GetObjectField(jniEnv, jlayout, jfidBounds);
+  jsize n_children = (*jniEnv)->GetArrayLength(jniEnv, jinstances);
+
+  (*jniEnv)->GetIntArrayRegion(jniEnv, jorigins, 0, 6, (jint*)data->origins);
+  data->grid = jaw_hit_grid_new((*jniEnv)->GetIntField(jniEnv, jlayout, jfidWidth),
+                                (*jniEnv)->GetIntField(jniEnv, jlayout, jfidHeight));
+  data->children = g_new0(JawComponentChild, n_children);
+
+  jlong *instances = (*jniEnv)->GetLongArrayElements(jniEnv, jinstances, NULL);
+  jint *bounds = (*jniEnv)->GetIntArrayElements(jniEnv, jbounds, NULL);
+  jsize i;
+  for (i = 0; i < n_children; i++)
+  {
+    JawImpl *child = (JawImpl*) (uintptr_t) instances[i];
+    data->children[i].jaw_impl = child;
+    g_object_add_weak_pointer(G_OBJECT(child), (gpointer*)&data->children[i].jaw_impl);
+    jaw_hit_grid_add(data->grid,
+                     bounds[4 * i], bounds[4 * i + 1],
+                     bounds[4 * i + 2], bounds[4 * i + 3]);
+
+    ComponentData *child_data = jaw_object_get_interface_data(JAW_OBJECT(child),
+                                                              INTERFACE_COMPONENT);
+    if (child_data != NULL)
+      jaw_component_set_layout_parent(child_data, jaw_impl, i);
+  }
+  data->n_children = n_children;
+  (*jniEnv)->ReleaseIntArrayElements(jniEnv, jbounds, bounds, JNI_ABORT);
+  (*jniEnv)->ReleaseLongArrayElements(jniEnv, jinstances, instances, JNI_ABORT);
+}
+
+/* Read the children of the component with AtkComponent.get_children_layout */
+static void
+jaw_component_read_layout (JNIEnv *jniEnv,
+                           JawImpl *jaw_impl,
+                           ComponentData *data,
+                           jobject atk_component)
+{
+  JAW_DEBUG_C("%p, %p, %p, %p", jniEnv, jaw_impl, data, atk_component);
+  if (jaw_impl_has_cell_pool(jniEnv, jaw_impl))
+  {
+    jaw_component_set_layout(jniEnv, jaw_impl, data, NULL);
+    return;
+  }
+
+  jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
+                                                  "org/GNOME/Accessibility/AtkComponent");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkComponent,
+                                          "get_children_layout",
+                                          "()Lorg/GNOME/Accessibility/AtkComponent$ChildrenLayout;");
+  jobject jlayout = (*jniEnv)->CallObjectMethod(jniEnv, atk_component, jmid);
+  jaw_component_set_layout(jniEnv, jaw_impl, data, jlayout);
+  (*jniEnv)->DeleteLocalRef(jniEnv, jlayout);
+}
+
+/*
+ * Read the layout of the parent with AtkComponent.get_parent_layout, which
+ * gives the extents of all the siblings of the component in one call, for
+ * ATs asking each of them in turn.  Tried once per layout serial.
+ */
+static gboolean
+jaw_component_read_parent_layout (JNIEnv *jniEnv,
+                                  ComponentData *data,
+                                  jobject atk_component)
+{
+  JAW_DEBUG_C("%p, %p, %p", jniEnv, data, atk_component);
+  gint serial = g_atomic_int_get(&jaw_component_layout_serial);
+  if (data->layout_parent_checked && data->layout_parent_serial == serial)
+    return FALSE;
+  /*
+   * One query after a change is cheaper asked alone, only a second one
+   * within the same layout tells that the AT goes through the siblings
+   */
+  if (jaw_component_extents_miss_serial != serial)
+  {
+    jaw_component_extents_miss_serial = serial;
+    return FALSE;
+  }
+  data->layout_parent_checked = TRUE;
+  data->layout_parent_serial = serial;
+
+  jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
+                                                  "org/GNOME/Accessibility/AtkComponent");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkComponent,
+                                          "get_parent_layout",
+                                          "()Lorg/GNOME/Accessibility/AtkComponent$ChildrenLayout;");
+  jobject jlayout = (*jniEnv)->CallObjectMethod(jniEnv, atk_component, jmid);
+  if (jlayout == NULL)
+    return FALSE;
+
+  jclass classLayout = (*jniEnv)->FindClass(jniEnv,
+                                            "org/GNOME/Accessibility/AtkComponent$ChildrenLayout");
+  jfieldID jfidInstance = (*jniEnv)->GetFieldID(jniEnv, classLayout, "instance", "J");
+  JawImpl *parent = (JawImpl*) (uintptr_t) (*jniEnv)->GetLongField(jniEnv, jlayout, jfidInstance);
+  ComponentData *parent_data = NULL;
+  if (parent != NULL)
+    parent_data = jaw_object_get_interface_data(JAW_OBJECT(parent), INTERFACE_COMPONENT);
+  if (parent_data == NULL || parent_data->atk_component == NULL)
+  {
+    (*jniEnv)->DeleteLocalRef(jniEnv, jlayout);
+    return FALSE;
+  }
+
+  jaw_component_set_layout(jniEnv, parent, parent_data, jlayout);
+  (*jniEnv)->DeleteLocalRef(jniEnv, jlayout);
+  return TRUE;
+}
+
+/* Extents of the component from the current layout of its parent */
+static gboolean
+jaw_component_get_cached_extents (JawImpl *jaw_impl,
+                                  ComponentData *data,
+                                  AtkCoordType coord_type,
+                                  gint *x,
+                                  gint *y,
+                                  gint *width,
+                                  gint *height)
+{
+  if (coord_type != ATK_XY_SCREEN && coord_type != ATK_XY_WINDOW && coord_type != ATK_XY_PARENT)
+    return FALSE;
+  if (data->layout_parent == NULL)
+    return FALSE;
+
+  ComponentData *parent_data = jaw_object_get_interface_data(JAW_OBJECT(data->layout_parent),
+                                                             INTERFACE_COMPONENT);
+  if (parent_data == NULL || !jaw_component_layout_is_current(parent_data) ||
+      data->layout_index >= parent_data->n_children ||
+      parent_data->children[data->layout_index].jaw_impl != jaw_impl)
+    return FALSE;
+
+  jaw_hit_grid_get_rect(parent_data->grid, data->layout_index, x, y, width, height);
+  /* PARENT extents are relative to the parent itself */
+  if (coord_type != ATK_XY_PARENT)
+  {
+    *x += parent_data->origins[2 * coord_type];
+    *y += parent_data->origins[2 * coord_type + 1];
+  }
+  return TRUE;
+}
+
+/* New reference on the child at the point, NULL to ask Java */
+static AtkObject*
+jaw_component_find_child (JNIEnv *jniEnv,
+                          JawImpl *jaw_impl,
+                          ComponentData *data,
+                          jobject atk_component,
+                          gint x,
+                          gint y,
+                          AtkCoordType coord_type)
+{
+  JAW_DEBUG_C("%p, %p, %p, %p, %d, %d, %d", jniEnv, jaw_impl, data, atk_component, x, y, coord_type);
+  if (coord_type != ATK_XY_SCREEN && coord_type != ATK_XY_WINDOW && coord_type != ATK_XY_PARENT)
+    return NULL;
+
+  if (!jaw_component_layout_is_current(data))
+    jaw_component_read_layout(jniEnv, jaw_impl, data, atk_component);
+
+  if (data->grid == NULL)
+    return NULL;
+
+  gint i = jaw_hit_grid_lookup(data->grid,
+                               x - data->origins[2 * coord_type],
+                               y - data->origins[2 * coord_type + 1]);
+  if (i < 0 || data->children[i].jaw_impl == NULL)
+    return NULL;
+
+  return g_object_ref(ATK_OBJECT(data->children[i].jaw_impl));
+}
+
 static gboolean
 jaw_component_contains (AtkComponent *component, gint x, gint y, AtkCoordType coord_type)
 {
   JAW_DEBUG_C("%p, %d, %d, %d", component, x, y, coord_type);
   JAW_GET_COMPONENT(component, FALSE);
+  jaw_component_window_to_screen(jniEnv, data, atk_component, &x, &y, &coord_type);
 
   jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
                                                   "org/GNOME/Accessibility/AtkComponent");
@@ -146,6 +578,18 @@ jaw_component_ref_accessible_at_point (AtkComponent *component, gint x, gint y,
   JAW_DEBUG_C("%p, %d, %d, %d", component, x, y, coord_type);
   JAW_GET_COMPONENT(component, NULL);
 
+  AtkObject *child = jaw_component_find_child(jniEnv,
+                                              (JawImpl*)jaw_obj,
+                                              data,
+                                              atk_component,
+                                              x, y, coord_type);
+  if (child != NULL)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_component);
+    return child;
+  }
+  jaw_component_window_to_screen(jniEnv, data, atk_component, &x, &y, &coord_type);
+
   jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
                                                   "org/GNOME/Accessibility/AtkComponent");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -189,6 +633,22 @@ jaw_component_get_extents (AtkComponent *component,
     return;
 
   JAW_GET_COMPONENT(component, );
+  data->extents_queried = TRUE;
+
+  JawImpl *jaw_impl = (JawImpl*)jaw_obj;
+  if (jaw_component_get_cached_extents(jaw_impl, data, coord_type, x, y, width, height) ||
+      (jaw_component_read_parent_layout(jniEnv, data, atk_component) &&
+       jaw_component_get_cached_extents(jaw_impl, data, coord_type, x, y, width, height)))
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_component);
+    return;
+  }
+
+  /* WINDOW extents are the SCREEN ones moved by the kept window origin */
+  gint window_x = 0, window_y = 0;
+  if (coord_type == ATK_XY_WINDOW &&
+      jaw_component_get_window_origin(jniEnv, data, atk_component, &window_x, &window_y))
+    coord_type = ATK_XY_SCREEN;
 
   jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv,
                                                   "org/GNOME/Accessibility/AtkComponent");
@@ -206,15 +666,9 @@ jaw_component_get_extents (AtkComponent *component,
     return;
   }
 
-  jclass classRectangle = (*jniEnv)->FindClass(jniEnv, "java/awt/Rectangle");
-  jfieldID jfidX = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "x", "I");
-  jfieldID jfidY = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "y", "I");
-  jfieldID jfidW = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "width", "I");
-  jfieldID jfidH = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "height", "I");
-  (*x)      = (gint)(*jniEnv)->GetIntField(jniEnv, jrectangle, jfidX);
-  (*y)      = (gint)(*jniEnv)->GetIntField(jniEnv, jrectangle, jfidY);
-  (*width)  = (gint)(*jniEnv)->GetIntField(jniEnv, jrectangle, jfidW);
-  (*height) = (gint)(*jniEnv)->GetIntField(jniEnv, jrectangle, jfidH);
+  jaw_util_get_rect_info(jniEnv, jrectangle, x, y, width, height);
+  (*x) -= window_x;
+  (*y) -= window_y;
 }
 
 static gboolean
@@ -227,6 +681,7 @@ jaw_component_set_extents (AtkComponent *component,
 {
   JAW_DEBUG_C("%p, %d, %d, %d, %d, %d", component, x, y, width, height, coord_type);
   JAW_GET_COMPONENT(component, FALSE);
+  jaw_component_window_to_screen(jniEnv, data, atk_component, &x, &y, &coord_type);
 
   jclass classAtkComponent = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkComponent");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkComponent, "set_extents", "(IIIII)Z");
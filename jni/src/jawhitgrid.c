@@ -0,0 +1,161 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include "jawutil.h"
+#include "jawhitgrid.h"
+
+/* At most this many buckets along each side of the grid */
+#define JAW_HIT_GRID_MAX_BUCKETS 32
+/* And buckets at least this many pixels wide and high */
+#define JAW_HIT_GRID_MIN_BUCKET_SIZE 16
+
+typedef struct _JawHitRect {
+  gint x;
+  gint y;
+  gint width;
+  gint height;
+} JawHitRect;
+
+struct _JawHitGrid {
+  gint width;
+  gint height;
+  gint bucket_size;
+  gint n_columns;
+  gint n_rows;
+  GArray *rects;
+  /* n_columns * n_rows arrays of rect indexes in increasing order, NULL when empty */
+  GArray **buckets;
+};
+
+JawHitGrid*
+jaw_hit_grid_new (gint width, gint height)
+{
+  JAW_DEBUG_C("%d, %d", width, height);
+  JawHitGrid *grid = g_new0(JawHitGrid, 1);
+  gint side = MAX(width, height);
+
+  grid->width = MAX(width, 0);
+  grid->height = MAX(height, 0);
+  grid->bucket_size = MAX(JAW_HIT_GRID_MIN_BUCKET_SIZE,
+                          (side + JAW_HIT_GRID_MAX_BUCKETS - 1) / JAW_HIT_GRID_MAX_BUCKETS);
+  grid->n_columns = MAX(1, (grid->width + grid->bucket_size - 1) / grid->bucket_size);
+  grid->n_rows = MAX(1, (grid->height + grid->bucket_size - 1) / grid->bucket_size);
+  grid->rects = g_array_new(FALSE, FALSE, sizeof(JawHitRect));
+  grid->buckets = g_new0(GArray*, grid->n_columns * grid->n_rows);
+
+  return grid;
+}
+
+void
+jaw_hit_grid_free (JawHitGrid *grid)
+{
+  JAW_DEBUG_C("%p", grid);
+  if (grid == NULL)
+    return;
+
+  gint i;
+  for (i = 0; i < grid->n_columns * grid->n_rows; i++)
+  {
+    if (grid->buckets[i] != NULL)
+      g_array_free(grid->buckets[i], TRUE);
+  }
+  g_free(grid->buckets);
+  g_array_free(grid->rects, TRUE);
+  g_free(grid);
+}
+
+/* The part of the rectangle outside of the grid can never be hit */
+void
+jaw_hit_grid_add (JawHitGrid *grid, gint x, gint y, gint width, gint height)
+{
+  JAW_DEBUG_C("%p, %d, %d, %d, %d", grid, x, y, width, height);
+  JawHitRect rect = { x, y, width, height };
+  guint index = grid->rects->len;
+
+  g_array_append_val(grid->rects, rect);
+
+  if (width <= 0 || height <= 0 ||
+      x >= grid->width || y >= grid->height ||
+      x + width <= 0 || y + height <= 0)
+    return;
+
+  gint first_column = MAX(x, 0) / grid->bucket_size;
+  gint last_column = (MIN(x + width, grid->width) - 1) / grid->bucket_size;
+  gint first_row = MAX(y, 0) / grid->bucket_size;
+  gint last_row = (MIN(y + height, grid->height) - 1) / grid->bucket_size;
+
+  gint row, column;
+  for (row = first_row; row <= last_row; row++)
+  {
+    for (column = first_column; column <= last_column; column++)
+    {
+      GArray **bucket = &grid->buckets[row * grid->n_columns + column];
+      if (*bucket == NULL)
+        *bucket = g_array_new(FALSE, FALSE, sizeof(guint));
+      g_array_append_val(*bucket, index);
+    }
+  }
+}
+
+gint
+jaw_hit_grid_get_n_rects (JawHitGrid *grid)
+{
+  return grid->rects->len;
+}
+
+void
+jaw_hit_grid_get_rect (JawHitGrid *grid,
+                       gint index,
+                       gint *x,
+                       gint *y,
+                       gint *width,
+                       gint *height)
+{
+  JawHitRect *rect = &g_array_index(grid->rects, JawHitRect, index);
+  *x = rect->x;
+  *y = rect->y;
+  *width = rect->width;
+  *height = rect->height;
+}
+
+/* Index of the first rectangle added which contains the point, -1 if none */
+gint
+jaw_hit_grid_lookup (JawHitGrid *grid, gint x, gint y)
+{
+  JAW_DEBUG_C("%p, %d, %d", grid, x, y);
+  if (x < 0 || y < 0 || x >= grid->width || y >= grid->height)
+    return -1;
+
+  GArray *bucket = grid->buckets[(y / grid->bucket_size) * grid->n_columns +
+                                 x / grid->bucket_size];
+  if (bucket == NULL)
+    return -1;
+
+  guint i;
+  for (i = 0; i < bucket->len; i++)
+  {
+    guint index = g_array_index(bucket, guint, i);
+    JawHitRect *rect = &g_array_index(grid->rects, JawHitRect, index);
+    if (x >= rect->x && x < rect->x + rect->width &&
+        y >= rect->y && y < rect->y + rect->height)
+      return index;
+  }
+
+  return -1;
+}
@@ -0,0 +1,46 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_HIT_GRID_H_
+#define _JAW_HIT_GRID_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * The rectangles of the children of a container, in the container's own
+ * coordinates, sorted into a coarse grid of buckets so that finding the
+ * one at a point only looks at the few rectangles of its bucket.  The
+ * first rectangle added wins where they overlap, as in
+ * AccessibleComponent.getAccessibleAt().  It knows nothing about Java:
+ * jawcomponent.c fills it and says when it is out of date.
+ */
+typedef struct _JawHitGrid		JawHitGrid;
+
+JawHitGrid* jaw_hit_grid_new(gint, gint);
+void jaw_hit_grid_free(JawHitGrid*);
+
+void jaw_hit_grid_add(JawHitGrid*, gint, gint, gint, gint);
+gint jaw_hit_grid_get_n_rects(JawHitGrid*);
+void jaw_hit_grid_get_rect(JawHitGrid*, gint, gint*, gint*, gint*, gint*);
+gint jaw_hit_grid_lookup(JawHitGrid*, gint, gint);
+
+G_END_DECLS
+
+#endif
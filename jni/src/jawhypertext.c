@@ -29,9 +29,21 @@ static gint			jaw_hypertext_get_n_links	(AtkHypertext *hypertext);
 static gint			jaw_hypertext_get_link_index	(AtkHypertext *hypertext,
 								 gint char_index);
 
+/*
+ * Documents may hold thousands of links, which ATs go through one after the
+ * other.  The start and end character offsets of all of them are read in
+ * one call after each change, see jaw_hypertext_invalidate(), so that the
+ * number of links and the link at an offset are answered from them, and
+ * link_table keeps the JawHyperlink of each link until then.  Only used from
+ * the jaw thread.
+ */
 typedef struct _HypertextData {
 	jobject atk_hypertext;
 	GHashTable *link_table;
+	gboolean links_valid;
+	gint n_links;
+	/* start, end of each link, NULL if they are not sorted */
+	gint *link_offsets;
 } HypertextData;
 
 #define JAW_GET_HYPERTEXT(hypertext, def_ret) \
@@ -79,19 +91,77 @@ jaw_hypertext_data_finalize (gpointer p)
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
 	if (data && data->atk_hypertext) {
-		g_hash_table_remove_all(data->link_table);
+		g_hash_table_destroy(data->link_table);
+		data->link_table = NULL;
+		g_free(data->link_offsets);
+		data->link_offsets = NULL;
 
 		(*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_hypertext);
 		data->atk_hypertext = NULL;
 	}
 }
 
+/* The links changed, from the jaw thread */
+void
+jaw_hypertext_invalidate (JawObject *jaw_obj)
+{
+	JAW_DEBUG_C("%p", jaw_obj);
+	HypertextData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_HYPERTEXT);
+	if (data == NULL || data->link_table == NULL)
+		return;
+
+	g_hash_table_remove_all(data->link_table);
+	g_free(data->link_offsets);
+	data->link_offsets = NULL;
+	data->n_links = 0;
+	data->links_valid = FALSE;
+}
+
+/* Whether the offsets of the links are known, reading them if needed */
+static gboolean
+jaw_hypertext_get_links (JNIEnv *jniEnv, HypertextData *data, jobject atk_hypertext)
+{
+	if (data->links_valid)
+		return TRUE;
+
+	jclass classAtkHypertext = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkHypertext");
+	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkHypertext, "get_link_offsets", "()[I");
+	jintArray joffsets = (*jniEnv)->CallObjectMethod(jniEnv, atk_hypertext, jmid);
+	if (joffsets == NULL)
+		return FALSE;
+
+	jsize length = (*jniEnv)->GetArrayLength(jniEnv, joffsets);
+	data->n_links = length / 2;
+	data->link_offsets = g_new(gint, 2 * data->n_links);
+	(*jniEnv)->GetIntArrayRegion(jniEnv, joffsets, 0, 2 * data->n_links, (jint*)data->link_offsets);
+	(*jniEnv)->DeleteLocalRef(jniEnv, joffsets);
+
+	/* Overlapping links can't be searched, get_link_index asks Java then */
+	gint i;
+	for (i = 1; i < data->n_links; i++) {
+		if (data->link_offsets[2 * i] < data->link_offsets[2 * i - 1]) {
+			g_free(data->link_offsets);
+			data->link_offsets = NULL;
+			break;
+		}
+	}
+
+	data->links_valid = TRUE;
+	return TRUE;
+}
+
 static AtkHyperlink*
 jaw_hypertext_get_link (AtkHypertext *hypertext, gint link_index)
 {
 	JAW_DEBUG_C("%p, %d", hypertext, link_index);
 	JAW_GET_HYPERTEXT(hypertext, NULL);
 
+	JawHyperlink *jaw_hyperlink = g_hash_table_lookup(data->link_table, GINT_TO_POINTER(link_index));
+	if (jaw_hyperlink != NULL) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_hypertext);
+		return ATK_HYPERLINK(jaw_hyperlink);
+	}
+
 	jclass classAtkHypertext = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkHypertext");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkHypertext, "get_link", "(I)Lorg/GNOME/Accessibility/AtkHyperlink;");
 	jobject jhyperlink = (*jniEnv)->CallObjectMethod(jniEnv, atk_hypertext, jmid, (jint)link_index);
@@ -101,7 +171,7 @@ jaw_hypertext_get_link (AtkHypertext *hypertext, gint link_index)
 		return NULL;
 	}
 
-	JawHyperlink *jaw_hyperlink = jaw_hyperlink_new(jhyperlink);
+	jaw_hyperlink = jaw_hyperlink_new(jhyperlink);
 	g_hash_table_insert(data->link_table, GINT_TO_POINTER(link_index), (gpointer)jaw_hyperlink);
 
 	return ATK_HYPERLINK(jaw_hyperlink);
@@ -113,6 +183,11 @@ jaw_hypertext_get_n_links (AtkHypertext *hypertext)
 	JAW_DEBUG_C("%p", hypertext);
 	JAW_GET_HYPERTEXT(hypertext, 0);
 
+	if (jaw_hypertext_get_links(jniEnv, data, atk_hypertext)) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_hypertext);
+		return data->n_links;
+	}
+
 	jclass classAtkHypertext = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkHypertext");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkHypertext, "get_n_links", "()I");
 
@@ -127,6 +202,24 @@ jaw_hypertext_get_link_index (AtkHypertext *hypertext, gint char_index)
 	JAW_DEBUG_C("%p, %d", hypertext, char_index);
 	JAW_GET_HYPERTEXT(hypertext, 0);
 
+	if (jaw_hypertext_get_links(jniEnv, data, atk_hypertext) && data->link_offsets != NULL) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_hypertext);
+
+		/* Last link starting at or before char_index */
+		gint low = 0;
+		gint high = data->n_links;
+		while (low < high) {
+			gint mid = (low + high) / 2;
+			if (data->link_offsets[2 * mid] <= char_index)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		if (low > 0 && char_index < data->link_offsets[2 * (low - 1) + 1])
+			return low - 1;
+		return -1;
+	}
+
 	jclass classAtkHypertext = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkHypertext");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkHypertext, "get_link_index", "(I)I");
 
@@ -28,6 +28,7 @@
 #include "jawimpl.h"
 #include "jawtoplevel.h"
 #include "jawobject.h"
+#include "jawcellpool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,9 @@ static GHashTable *typeTable = NULL;
 static GMutex objectTableMutex;
 static GHashTable *objectTable = NULL;
 
+/* Most cells kept for each container with transient children */
+#define JAW_CELL_POOL_SIZE 256
+
 static void
 object_table_insert (JNIEnv *jniEnv, jobject ac, JawImpl* jaw_impl)
 {
@@ -147,6 +151,7 @@ object_table_gc(JNIEnv *jniEnv)
       JAW_DEBUG_JNI("%x: %d", i, count[i]);
     }
   }
+  JAW_DEBUG_JNI("%d property change listeners", jaw_object_get_n_listeners());
 
   if (list)
     jni_main_idle_add(jni_object_table_gc, list);
@@ -361,6 +366,133 @@ jaw_impl_find_instance (JNIEnv *jniEnv, jobject ac)
   return jaw_impl;
 }
 
+/*
+ * Swing makes up a new AccessibleContext each time a cell of a JTable, JList
+ * or JTree is asked for, and each one would get its own JawImpl, listener
+ * and objectTable entry until the next GC.  The cells of such containers are
+ * instead kept in a bounded pool, which gives the same object back for the
+ * same cell without calling into Java, and lets the others be collected.
+ */
+static JawCellPool*
+jaw_impl_get_cell_pool (JNIEnv *jniEnv, JawImpl *container)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, container);
+  if (container->cells_checked)
+    return container->cells;
+
+  JawObject *jaw_obj = JAW_OBJECT(container);
+  jobject ac = (*jniEnv)->NewGlobalRef(jniEnv, jaw_obj->acc_context);
+  if (ac == NULL)
+    return NULL;
+
+  jclass atkObject = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkObject");
+  jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv,
+                                                atkObject,
+                                                "hasTransientChildren",
+                                                "(Ljavax/accessibility/AccessibleContext;)Z");
+  jboolean jtransient = (*jniEnv)->CallStaticBooleanMethod(jniEnv, atkObject, jmid, ac);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+
+  container->cells_checked = TRUE;
+  if (jtransient)
+    container->cells = jaw_cell_pool_new(JAW_CELL_POOL_SIZE);
+  return container->cells;
+}
+
+/* New reference on the pooled (row, column) cell of container, NULL if none */
+AtkObject*
+jaw_impl_ref_cell (JNIEnv *jniEnv, JawImpl *container, gint row, gint column)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d", jniEnv, container, row, column);
+  JawCellPool *pool = jaw_impl_get_cell_pool(jniEnv, container);
+  if (pool == NULL)
+    return NULL;
+
+  JawImpl *jaw_impl = jaw_cell_pool_lookup(pool, row, column);
+  if (jaw_impl == NULL)
+    return NULL;
+
+  g_object_ref(G_OBJECT(jaw_impl));
+  return ATK_OBJECT(jaw_impl);
+}
+
+/* New reference on the JawImpl of child_ac, pooled as (row, column) of container */
+AtkObject*
+jaw_impl_ref_cell_instance (JNIEnv *jniEnv,
+                            JawImpl *container,
+                            gint row,
+                            gint column,
+                            jobject child_ac)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %p", jniEnv, container, row, column, child_ac);
+  JawImpl *jaw_impl = jaw_impl_get_instance_from_jaw(jniEnv, child_ac);
+  if (jaw_impl == NULL)
+    return NULL;
+
+  JawCellPool *pool = jaw_impl_get_cell_pool(jniEnv, container);
+  if (pool != NULL)
+    jaw_cell_pool_insert(jniEnv, pool, row, column, jaw_impl, child_ac);
+
+  g_object_ref(G_OBJECT(jaw_impl));
+  return ATK_OBJECT(jaw_impl);
+}
+
+gboolean
+jaw_impl_has_cell_pool (JNIEnv *jniEnv, JawImpl *container)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, container);
+  return jaw_impl_get_cell_pool(jniEnv, container) != NULL;
+}
+
+/* Keep jaw_impl, already made for child_ac, as (row, column) of container */
+void
+jaw_impl_pool_cell (JNIEnv *jniEnv,
+                    JawImpl *container,
+                    gint row,
+                    gint column,
+                    JawImpl *jaw_impl,
+                    jobject child_ac)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %p, %p", jniEnv, container, row, column, jaw_impl, child_ac);
+  JawCellPool *pool = jaw_impl_get_cell_pool(jniEnv, container);
+  if (pool != NULL)
+    jaw_cell_pool_insert(jniEnv, pool, row, column, jaw_impl, child_ac);
+}
+
+/* The cells moved or changed, from the jaw thread */
+void
+jaw_impl_flush_cells (JNIEnv *jniEnv, JawImpl *container)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, container);
+  jaw_object_drop_read_ahead();
+  if (container->cells != NULL)
+    jaw_cell_pool_clear(jniEnv, container->cells);
+}
+
+void
+jaw_impl_flush_selected_cells (JNIEnv *jniEnv, JawImpl *container)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, container);
+  if (container->cells != NULL)
+    jaw_cell_pool_remove_column(jniEnv, container->cells, JAW_CELL_POOL_SELECTION);
+}
+
+/* Only the cells of the given rows and columns moved or changed */
+void
+jaw_impl_flush_cell_range (JNIEnv *jniEnv,
+                           JawImpl *container,
+                           gint first_row,
+                           gint last_row,
+                           gint first_column,
+                           gint last_column)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %d, %d", jniEnv, container, first_row, last_row, first_column, last_column);
+  jaw_object_drop_read_ahead();
+  if (container->cells != NULL)
+    jaw_cell_pool_remove_range(jniEnv, container->cells,
+                               first_row, last_row, first_column, last_column);
+}
+
 static void
 jaw_impl_class_intern_init (gpointer klass, gpointer data)
 {
@@ -545,9 +677,13 @@ jaw_impl_finalize(GObject *gobject)
 
   JNIEnv *jniEnv = jaw_util_get_jni_env();
 
+  jaw_object_unlisten(jaw_obj, jniEnv);
   (*jniEnv)->DeleteWeakGlobalRef(jniEnv, jaw_obj->acc_context);
   jaw_obj->acc_context = NULL;
 
+  jaw_cell_pool_free(jniEnv, jaw_impl->cells);
+  jaw_impl->cells = NULL;
+
   /* Interface finalize */
   GHashTableIter iter;
   gpointer value;
@@ -593,19 +729,7 @@ jaw_impl_initialize (AtkObject *atk_obj, gpointer data)
 {
   JAW_DEBUG_C("%p, %p", atk_obj, data);
   ATK_OBJECT_CLASS(jaw_impl_parent_class)->initialize(atk_obj, data);
-
-  JawObject *jaw_obj = JAW_OBJECT(atk_obj);
-  JNIEnv *jniEnv = jaw_util_get_jni_env();
-  jobject ac = (*jniEnv)->NewGlobalRef(jniEnv, jaw_obj->acc_context);
-
-  jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv,
-                                                "org/GNOME/Accessibility/AtkWrapper");
-  jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv,
-                                                classAtkWrapper,
-                                                "registerPropertyChangeListener",
-                                                "(Ljavax/accessibility/AccessibleContext;)V");
-  (*jniEnv)->CallStaticVoidMethod(jniEnv, classAtkWrapper, jmid, ac);
-  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+  /* The property change listener waits for jaw_object_listen() */
 }
 
 static gboolean
@@ -51,11 +51,22 @@ struct _JawImpl
 	GHashTable *ifaceTable;
 	gint hash_key;
 	unsigned tflag;
+
+	/* Cells handed out, when the children are transient */
+	struct _JawCellPool *cells;
+	gboolean cells_checked;
 };
 
 JawImpl* jaw_impl_get_instance(JNIEnv*, jobject);
 JawImpl* jaw_impl_get_instance_from_jaw(JNIEnv*, jobject);
 JawImpl* jaw_impl_find_instance(JNIEnv*, jobject);
+AtkObject* jaw_impl_ref_cell(JNIEnv*, JawImpl*, gint, gint);
+AtkObject* jaw_impl_ref_cell_instance(JNIEnv*, JawImpl*, gint, gint, jobject);
+gboolean jaw_impl_has_cell_pool(JNIEnv*, JawImpl*);
+void jaw_impl_pool_cell(JNIEnv*, JawImpl*, gint, gint, JawImpl*, jobject);
+void jaw_impl_flush_cells(JNIEnv*, JawImpl*);
+void jaw_impl_flush_selected_cells(JNIEnv*, JawImpl*);
+void jaw_impl_flush_cell_range(JNIEnv*, JawImpl*, gint, gint, gint, gint);
 GHashTable* jaw_impl_get_object_hash_table(void);
 GMutex* jaw_impl_get_object_hash_table_mutex(void);
 void object_table_gc(JNIEnv *jniEnv);
@@ -75,6 +86,11 @@ extern void jaw_action_data_finalize(gpointer);
 extern void jaw_component_interface_init(AtkComponentIface*, gpointer);
 extern gpointer jaw_component_data_init(jobject);
 extern void jaw_component_data_finalize(gpointer);
+extern void jaw_component_layout_changed(void);
+extern gint jaw_component_get_layout_serial(void);
+extern void jaw_component_hierarchy_changed(void);
+extern void jaw_component_invalidate_window_origin(JawObject*);
+extern gboolean jaw_component_extents_queried(JawObject*);
 
 extern void jaw_editable_text_interface_init(AtkEditableTextIface*, gpointer);
 extern gpointer jaw_editable_text_data_init(jobject);
@@ -83,6 +99,7 @@ extern void jaw_editable_text_data_finalize (gpointer);
 extern void jaw_hypertext_interface_init(AtkHypertextIface*, gpointer);
 extern gpointer jaw_hypertext_data_init(jobject);
 extern void jaw_hypertext_data_finalize(gpointer);
+extern void jaw_hypertext_invalidate(JawObject*);
 
 extern void jaw_image_interface_init(AtkImageIface*, gpointer);
 extern gpointer jaw_image_data_init(jobject);
@@ -91,10 +108,29 @@ extern void jaw_image_data_finalize(gpointer);
 extern void jaw_selection_interface_init(AtkSelectionIface*, gpointer);
 extern gpointer jaw_selection_data_init(jobject);
 extern void jaw_selection_data_finalize(gpointer);
+extern void jaw_selection_invalidate(JawObject*);
 
 extern void jaw_table_interface_init (AtkTableIface*, gpointer);
 extern gpointer jaw_table_data_init (jobject);
 extern void jaw_table_data_finalize (gpointer);
+extern void jaw_table_invalidate (JawObject*, guint);
+extern void jaw_table_shift_rows (JawObject*, gint, gint);
+extern void jaw_table_shift_columns (JawObject*, gint, gint);
+extern void jaw_table_update_cells (JawObject*, gint, gint, gint, gint);
+extern gboolean jaw_table_reorder_rows (JawObject*, gint);
+
+/* TableData fields cached until jaw_table_invalidate() */
+#define JAW_TABLE_N_ROWS		(1 << 0)
+#define JAW_TABLE_N_COLUMNS		(1 << 1)
+#define JAW_TABLE_CAPTION		(1 << 2)
+#define JAW_TABLE_SUMMARY		(1 << 3)
+#define JAW_TABLE_COLUMN_HEADER		(1 << 4)
+#define JAW_TABLE_ROW_HEADER		(1 << 5)
+#define JAW_TABLE_COLUMN_DESCRIPTION	(1 << 6)
+#define JAW_TABLE_ROW_DESCRIPTION	(1 << 7)
+#define JAW_TABLE_SELECTED_ROWS		(1 << 8)
+#define JAW_TABLE_N_FIELDS		9
+#define JAW_TABLE_ALL			((1 << JAW_TABLE_N_FIELDS) - 1)
 
 extern void jaw_table_cell_interface_init (AtkTableCellIface*, gpointer);
 extern gpointer jaw_table_cell_data_init (jobject ac);
@@ -103,6 +139,9 @@ extern void jaw_table_cell_data_finalize (gpointer);
 extern void jaw_text_interface_init(AtkTextIface*, gpointer);
 extern gpointer	jaw_text_data_init(jobject);
 extern void jaw_text_data_finalize(gpointer);
+extern void jaw_text_mirror_changed(JNIEnv*, jobject, jint, jint, jstring, jint);
+extern void jaw_text_caret_moved(JawObject*, gint, jint);
+extern void jaw_text_count_changed(JawObject*, gint, jint);
 
 extern void jaw_value_interface_init (AtkValueIface*, gpointer);
 extern gpointer jaw_value_data_init (jobject);
@@ -23,6 +23,7 @@
 #include "jawobject.h"
 #include "jawutil.h"
 #include "jawimpl.h"
+#include "jawcellpool.h"
 #include "jawtoplevel.h"
 
 #ifdef __cplusplus
@@ -74,7 +75,8 @@ static guint jaw_window_signals[LAST_SIGNAL] = { 0, };
 G_DEFINE_TYPE (JawObject, jaw_object, ATK_TYPE_OBJECT);
 
 #define JAW_GET_OBJECT(atk_obj, def_ret) \
-  JAW_GET_OBJ(atk_obj, JAW_OBJECT, JawObject, jaw_obj, acc_context, jniEnv, ac, def_ret)
+  JAW_GET_OBJ(atk_obj, JAW_OBJECT, JawObject, jaw_obj, acc_context, jniEnv, ac, def_ret) \
+  jaw_object_listen(jaw_obj, jniEnv);
 
 static guint
 jaw_window_add_signal (const gchar *name, JawObjectClass *klass)
@@ -180,24 +182,11 @@ jaw_object_finalize (GObject *gobject)
   AtkObject *atk_obj = ATK_OBJECT(gobject);
   JNIEnv *jniEnv = jaw_util_get_jni_env();
 
-  if (atk_obj->name != NULL)
-  {
-    (*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrName, atk_obj->name);
-    (*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrName);
-    jaw_obj->jstrName = NULL;
-    atk_obj->name = NULL;
-  }
-
-  if (atk_obj->description != NULL)
-  {
-    (*jniEnv)->ReleaseStringUTFChars(jniEnv,
-                                     jaw_obj->jstrDescription,
-                                     atk_obj->description);
+  g_free(atk_obj->name);
+  atk_obj->name = NULL;
 
-    (*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrDescription);
-    jaw_obj->jstrDescription = NULL;
-    atk_obj->description = NULL;
-  }
+  g_free(atk_obj->description);
+  atk_obj->description = NULL;
 
   if (jaw_obj->locale != NULL)
   {
@@ -266,11 +255,37 @@ jaw_object_set_parent(AtkObject *atk_obj, AtkObject *parent)
   (*jniEnv)->DeleteGlobalRef(jniEnv, pa);
 }
 
+/*
+ * Fields read ahead only answer until the next read ahead, or until the
+ * cells they were read with are flushed, see jaw_object_drop_read_ahead().
+ * Only used from the jaw thread.
+ */
+static guint jaw_object_read_ahead_serial = 0;
+
+/* Whether field was read ahead, and the next query has to go to Java again */
+static gboolean
+jaw_object_take_read_ahead (AtkObject *atk_obj, guint field)
+{
+  JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+  if (jaw_obj == NULL)
+    return FALSE;
+  if (jaw_obj->read_ahead_serial != jaw_object_read_ahead_serial)
+    jaw_obj->read_ahead = 0;
+  if (!(jaw_obj->read_ahead & field))
+    return FALSE;
+
+  jaw_obj->read_ahead &= ~field;
+  return TRUE;
+}
+
 static const gchar*
 jaw_object_get_name (AtkObject *atk_obj)
 {
   JAW_DEBUG_C("%p", atk_obj);
 
+  if (jaw_object_take_read_ahead(atk_obj, JAW_OBJECT_READ_AHEAD_NAME))
+    return atk_obj->name;
+
   atk_obj->name = (gchar *)ATK_OBJECT_CLASS (parent_class)->get_name (atk_obj);
 
   if (atk_object_get_role(atk_obj) == ATK_ROLE_COMBO_BOX &&
@@ -299,20 +314,16 @@ jaw_object_get_name (AtkObject *atk_obj)
 
   (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
 
-  if (atk_obj->name != NULL)
+  gchar *name = jaw_util_get_string_utf8(jniEnv, jstr);
+  /* Keep the string the caller may still hold if the name didn't change */
+  if (g_strcmp0(name, atk_obj->name) != 0)
   {
-    (*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrName, atk_obj->name);
-    (*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrName);
-    jaw_obj->jstrName = NULL;
-    atk_obj->name = NULL;
+    g_free(atk_obj->name);
+    atk_obj->name = name;
   }
-
-  if (jstr != NULL)
+  else
   {
-    jaw_obj->jstrName = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-    atk_obj->name = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv,
-                                                         jaw_obj->jstrName,
-                                                         NULL);
+    g_free(name);
   }
 
   if (atk_obj->name)
@@ -349,20 +360,15 @@ jaw_object_get_description (AtkObject *atk_obj)
 
   (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
 
-  if (atk_obj->description != NULL)
+  gchar *description = jaw_util_get_string_utf8(jniEnv, jstr);
+  if (g_strcmp0(description, atk_obj->description) != 0)
   {
-    (*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrDescription, atk_obj->description);
-    (*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrDescription);
-    jaw_obj->jstrDescription = NULL;
-    atk_obj->description = NULL;
+    g_free(atk_obj->description);
+    atk_obj->description = description;
   }
-
-  if (jstr != NULL)
+  else
   {
-    jaw_obj->jstrDescription = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-    atk_obj->description = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv,
-                                                                jaw_obj->jstrDescription,
-                                                                NULL);
+    g_free(description);
   }
 
   return atk_obj->description;
@@ -461,23 +467,10 @@ is_collapsed_java_state (JNIEnv *jniEnv, jobject jobj)
 }
 #endif
 
-static AtkStateSet*
-jaw_object_ref_state_set (AtkObject *atk_obj)
+/* Add the AtkStateType of the AccessibleState array jstate_arr to state_set */
+static void
+jaw_object_add_states (JNIEnv *jniEnv, AtkStateSet *state_set, jobjectArray jstate_arr)
 {
-  JAW_DEBUG_C("%p", atk_obj);
-  JAW_GET_OBJECT(atk_obj, NULL);
-
-  AtkStateSet* state_set = jaw_obj->state_set;
-  atk_state_set_clear_states( state_set );
-
-  jclass atkObject = (*jniEnv)->FindClass (jniEnv, "org/GNOME/Accessibility/AtkObject");
-  jmethodID jmid = (*jniEnv)->GetStaticMethodID (jniEnv, atkObject, "getArrayAccessibleState", "(Ljavax/accessibility/AccessibleContext;)[Ljavax/accessibility/AccessibleState;");
-  jobject jstate_arr = (*jniEnv)->CallStaticObjectMethod (jniEnv, atkObject, jmid, ac);
-
-  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
-  if (jstate_arr == NULL)
-    return NULL;
-
   jsize jarr_size = (*jniEnv)->GetArrayLength(jniEnv, jstate_arr);
   jsize i;
   for (i = 0; i < jarr_size; i++)
@@ -496,12 +489,158 @@ jaw_object_ref_state_set (AtkObject *atk_obj)
       atk_state_set_add_state( state_set, ATK_STATE_SENSITIVE );
     }
   }
+}
+
+static AtkStateSet*
+jaw_object_ref_state_set (AtkObject *atk_obj)
+{
+  JAW_DEBUG_C("%p", atk_obj);
+
+  if (jaw_object_take_read_ahead(atk_obj, JAW_OBJECT_READ_AHEAD_STATES))
+    return g_object_ref(JAW_OBJECT(atk_obj)->state_set);
+
+  JAW_GET_OBJECT(atk_obj, NULL);
+
+  AtkStateSet* state_set = jaw_obj->state_set;
+  atk_state_set_clear_states( state_set );
+
+  jclass atkObject = (*jniEnv)->FindClass (jniEnv, "org/GNOME/Accessibility/AtkObject");
+  jmethodID jmid = (*jniEnv)->GetStaticMethodID (jniEnv, atkObject, "getArrayAccessibleState", "(Ljavax/accessibility/AccessibleContext;)[Ljavax/accessibility/AccessibleState;");
+  jobject jstate_arr = (*jniEnv)->CallStaticObjectMethod (jniEnv, atkObject, jmid, ac);
+
+  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+  if (jstate_arr == NULL)
+    return NULL;
+
+  jaw_object_add_states(jniEnv, state_set, jstate_arr);
 
   g_object_ref(G_OBJECT(state_set));
 
   return state_set;
 }
 
+/* Objects with the property change listener, for debugging */
+static gint jaw_object_n_listeners = 0;
+
+/*
+ * Most objects are only made to send an event or to read the layout of
+ * their parent, and no AT ever asks about them.  So the property change
+ * listener, which makes Swing report each of their changes, is only added
+ * at the first request about the object, and removed with it.
+ */
+void
+jaw_object_listen (JawObject *jaw_obj, JNIEnv *jniEnv)
+{
+  if (jaw_obj->listen_checked)
+    return;
+
+  JAW_DEBUG_C("%p, %p", jaw_obj, jniEnv);
+  jaw_obj->listen_checked = TRUE;
+
+  jobject ac = (*jniEnv)->NewGlobalRef(jniEnv, jaw_obj->acc_context);
+  if (ac == NULL)
+    return;
+
+  jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv,
+                                                "org/GNOME/Accessibility/AtkWrapper");
+  jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv,
+                                                classAtkWrapper,
+                                                "registerPropertyChangeListener",
+                                                "(Ljavax/accessibility/AccessibleContext;)Z");
+  jaw_obj->listening = (*jniEnv)->CallStaticBooleanMethod(jniEnv, classAtkWrapper, jmid, ac);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+
+  if (jaw_obj->listening)
+    g_atomic_int_inc(&jaw_object_n_listeners);
+}
+
+/* Called before jaw_obj drops its AccessibleContext */
+void
+jaw_object_unlisten (JawObject *jaw_obj, JNIEnv *jniEnv)
+{
+  JAW_DEBUG_C("%p, %p", jaw_obj, jniEnv);
+  if (!jaw_obj->listening)
+    return;
+
+  jaw_obj->listening = FALSE;
+  g_atomic_int_add(&jaw_object_n_listeners, -1);
+
+  /* A collected AccessibleContext took the listener along */
+  jobject ac = (*jniEnv)->NewGlobalRef(jniEnv, jaw_obj->acc_context);
+  if (ac == NULL)
+    return;
+
+  jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv,
+                                                "org/GNOME/Accessibility/AtkWrapper");
+  jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv,
+                                                classAtkWrapper,
+                                                "unregisterPropertyChangeListener",
+                                                "(Ljavax/accessibility/AccessibleContext;)V");
+  (*jniEnv)->CallStaticVoidMethod(jniEnv, classAtkWrapper, jmid, ac);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+}
+
+gint
+jaw_object_get_n_listeners (void)
+{
+  return g_atomic_int_get(&jaw_object_n_listeners);
+}
+
+/*
+ * Name and states read in one go with those of other objects, such as the
+ * cells of a table row.  They answer the next get_name and ref_state_set,
+ * which then go to Java again since nothing tells when they change.  The
+ * caller starts each read with jaw_object_drop_read_ahead(), so that only
+ * the objects of the last one answer.
+ */
+void
+jaw_object_set_read_ahead (JawObject *jaw_obj,
+                           JNIEnv *jniEnv,
+                           jstring jname,
+                           jobjectArray jstate_arr)
+{
+  JAW_DEBUG_C("%p, %p, %p, %p", jaw_obj, jniEnv, jname, jstate_arr);
+  AtkObject *atk_obj = ATK_OBJECT(jaw_obj);
+
+  gchar *name = jaw_util_get_string_utf8(jniEnv, jname);
+  if (g_strcmp0(name, atk_obj->name) != 0)
+  {
+    g_free(atk_obj->name);
+    atk_obj->name = name;
+  }
+  else
+  {
+    g_free(name);
+  }
+  if (jaw_obj->read_ahead_serial != jaw_object_read_ahead_serial)
+    jaw_obj->read_ahead = 0;
+  jaw_obj->read_ahead_serial = jaw_object_read_ahead_serial;
+  jaw_obj->read_ahead |= JAW_OBJECT_READ_AHEAD_NAME;
+
+  if (jstate_arr != NULL)
+  {
+    atk_state_set_clear_states(jaw_obj->state_set);
+    jaw_object_add_states(jniEnv, jaw_obj->state_set, jstate_arr);
+    jaw_obj->read_ahead |= JAW_OBJECT_READ_AHEAD_STATES;
+  }
+}
+
+/* The name or states of jaw_obj changed, what was read ahead is stale */
+void
+jaw_object_clear_read_ahead (JawObject *jaw_obj)
+{
+  JAW_DEBUG_C("%p", jaw_obj);
+  jaw_obj->read_ahead = 0;
+}
+
+/* Whatever was read ahead so far is stale, from the jaw thread */
+void
+jaw_object_drop_read_ahead (void)
+{
+  JAW_DEBUG_C("");
+  jaw_object_read_ahead_serial++;
+}
+
 static const gchar *jaw_object_get_object_locale (AtkObject *atk_obj)
 {
   JAW_DEBUG_C("%p", atk_obj);
@@ -587,16 +726,22 @@ jaw_object_ref_child(AtkObject *atk_obj, gint i)
   JAW_DEBUG_C("%p, %d", atk_obj, i);
   JAW_GET_OBJECT(atk_obj, NULL);
 
+  AtkObject *obj = jaw_impl_ref_cell(jniEnv, (JawImpl*)jaw_obj, i, JAW_CELL_POOL_CHILD);
+  if (obj != NULL)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
+    return obj;
+  }
+
   jclass atkObject = (*jniEnv)->FindClass (jniEnv, "org/GNOME/Accessibility/AtkObject");
   jmethodID jmid = (*jniEnv)->GetStaticMethodID (jniEnv, atkObject, "getAccessibleChild", "(Ljavax/accessibility/AccessibleContext;I)Ljavax/accessibility/AccessibleContext;" );
   jobject child_ac = (*jniEnv)->CallStaticObjectMethod (jniEnv, atkObject, jmid, ac, i);
   (*jniEnv)->DeleteGlobalRef(jniEnv, ac);
 
-  AtkObject *obj = (AtkObject*) jaw_impl_get_instance_from_jaw( jniEnv, child_ac );
-  if (G_OBJECT(obj) != NULL)
-    g_object_ref(G_OBJECT(obj));
+  if (child_ac == NULL)
+    return NULL;
 
-  return obj;
+  return jaw_impl_ref_cell_instance(jniEnv, (JawImpl*)jaw_obj, i, JAW_CELL_POOL_CHILD, child_ac);
 }
 
 static JawObject*
@@ -40,15 +40,23 @@ struct _JawObject
 	AtkObject parent;
 	
 	jobject acc_context;
-	jstring jstrName;
-	jstring jstrDescription;
 	jstring jstrLocale;
 	gchar *locale;
 	AtkStateSet *state_set;
+	/* JAW_OBJECT_READ_AHEAD_* fields not asked for yet, while read_ahead_serial is current */
+	guint read_ahead;
+	guint read_ahead_serial;
+	/* Whether the property change listener was added, see jaw_object_listen() */
+	gboolean listen_checked;
+	gboolean listening;
 
 	GHashTable *storedData;
 };
 
+/* Fields of a JawObject read along with others, see jaw_object_set_read_ahead() */
+#define JAW_OBJECT_READ_AHEAD_NAME	(1 << 0)
+#define JAW_OBJECT_READ_AHEAD_STATES	(1 << 1)
+
 GType jaw_object_get_type (void);
 
 struct _JawObjectClass
@@ -59,6 +67,12 @@ struct _JawObjectClass
 };
 
 gpointer jaw_object_get_interface_data (JawObject*, guint);
+void jaw_object_set_read_ahead (JawObject*, JNIEnv*, jstring, jobjectArray);
+void jaw_object_clear_read_ahead (JawObject*);
+void jaw_object_drop_read_ahead (void);
+void jaw_object_listen (JawObject*, JNIEnv*);
+void jaw_object_unlisten (JawObject*, JNIEnv*);
+gint jaw_object_get_n_listeners (void);
 
 G_END_DECLS
 
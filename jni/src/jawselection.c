@@ -20,6 +20,7 @@
 #include <atk/atk.h>
 #include <glib.h>
 #include "jawimpl.h"
+#include "jawcellpool.h"
 #include "jawutil.h"
 
 static gboolean			jaw_selection_add_selection		(AtkSelection	*selection,
@@ -34,8 +35,18 @@ static gboolean			jaw_selection_remove_selection		(AtkSelection	*selection,
 									 gint		i);
 static gboolean			jaw_selection_select_all_selection	(AtkSelection	*selection);
 
+/*
+ * ATs ask whether each visible child of a list is selected, and how many
+ * are.  JLists tell when their selection changes, so the sorted indexes of
+ * the selected children are read once after each change, see
+ * jaw_selection_invalidate(), and these are answered from them.  Only used
+ * from the jaw thread.
+ */
 typedef struct _SelectionData {
 	jobject atk_selection;
+	gint *selected;
+	gint n_selected;
+	gboolean selected_valid;
 } SelectionData;
 
 #define JAW_GET_SELECTION(selection, def_ret) \
@@ -77,11 +88,52 @@ jaw_selection_data_finalize (gpointer p)
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
 	if (data && data->atk_selection) {
+		g_free(data->selected);
+		data->selected = NULL;
+
 		(*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_selection);
 		data->atk_selection = NULL;
 	}
 }
 
+/* The selection changed, from the jaw thread */
+void
+jaw_selection_invalidate (JawObject *jaw_obj)
+{
+	JAW_DEBUG_C("%p", jaw_obj);
+	SelectionData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_SELECTION);
+	if (data == NULL)
+		return;
+
+	g_free(data->selected);
+	data->selected = NULL;
+	data->n_selected = 0;
+	data->selected_valid = FALSE;
+}
+
+/* Whether the selected children are known, reading them if they can be kept */
+static gboolean
+jaw_selection_get_selected (JNIEnv *jniEnv, JawObject *jaw_obj, SelectionData *data, jobject atk_selection)
+{
+	if (data->selected_valid)
+		return TRUE;
+
+	/* Trees, java.awt.List and others don't send selection changes */
+	jclass classAtkSelection = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkSelection");
+	jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classAtkSelection, "_is_jlist", "Z");
+	if ((*jniEnv)->GetBooleanField(jniEnv, atk_selection, jfid) != JNI_TRUE)
+		return FALSE;
+
+	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "get_selected_children", "()[I");
+	jintArray jselected = (*jniEnv)->CallObjectMethod(jniEnv, atk_selection, jmid);
+	if (jselected == NULL)
+		return FALSE;
+
+	data->selected = jaw_util_get_sorted_ints(jniEnv, jselected, &data->n_selected);
+	data->selected_valid = TRUE;
+	return TRUE;
+}
+
 static gboolean
 jaw_selection_add_selection (AtkSelection *selection, gint i)
 {
@@ -92,6 +144,7 @@ jaw_selection_add_selection (AtkSelection *selection, gint i)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "add_selection", "(I)Z");
 	jboolean jbool = (*jniEnv)->CallBooleanMethod(jniEnv, atk_selection, jmid, (jint)i);
 	(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+	jaw_selection_invalidate(jaw_obj);
 
 	return jbool;
 }
@@ -106,6 +159,7 @@ jaw_selection_clear_selection (AtkSelection *selection)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "clear_selection", "()Z");
 	jboolean jbool = (*jniEnv)->CallBooleanMethod(jniEnv, atk_selection, jmid);
 	(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+	jaw_selection_invalidate(jaw_obj);
 
 	return jbool;
 }
@@ -116,6 +170,13 @@ jaw_selection_ref_selection (AtkSelection *selection, gint i)
 	JAW_DEBUG_C("%p, %d", selection, i);
 	JAW_GET_SELECTION(selection, NULL);
 
+	/* Flushed on selection changes */
+	AtkObject *obj = jaw_impl_ref_cell(jniEnv, (JawImpl*)jaw_obj, i, JAW_CELL_POOL_SELECTION);
+	if (obj) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+		return obj;
+	}
+
 	jclass classAtkSelection = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkSelection");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "ref_selection", "(I)Ljavax/accessibility/AccessibleContext;");
 	jobject child_ac = (*jniEnv)->CallObjectMethod(jniEnv, atk_selection, jmid, (jint)i);
@@ -124,11 +185,7 @@ jaw_selection_ref_selection (AtkSelection *selection, gint i)
 		return NULL;
 	}
 
-	AtkObject *obj = (AtkObject*) jaw_impl_get_instance_from_jaw( jniEnv, child_ac );
-	if (obj)
-	  g_object_ref (G_OBJECT(obj));
-
-	return obj;
+	return jaw_impl_ref_cell_instance(jniEnv, (JawImpl*)jaw_obj, i, JAW_CELL_POOL_SELECTION, child_ac);
 }
 
 static gint
@@ -137,6 +194,11 @@ jaw_selection_get_selection_count (AtkSelection *selection)
 	JAW_DEBUG_C("%p", selection);
 	JAW_GET_SELECTION(selection, 0);
 
+	if (jaw_selection_get_selected(jniEnv, jaw_obj, data, atk_selection)) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+		return data->n_selected;
+	}
+
 	jclass classAtkSelection = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkSelection");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "get_selection_count", "()I");
 	jint jcount = (*jniEnv)->CallIntMethod(jniEnv, atk_selection, jmid);
@@ -151,6 +213,11 @@ jaw_selection_is_child_selected (AtkSelection *selection, gint i)
 	JAW_DEBUG_C("%p, %d", selection, i);
 	JAW_GET_SELECTION(selection, FALSE);
 
+	if (jaw_selection_get_selected(jniEnv, jaw_obj, data, atk_selection)) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+		return jaw_util_sorted_ints_contain(data->selected, data->n_selected, i);
+	}
+
 	jclass classAtkSelection = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkSelection");
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "is_child_selected", "(I)Z");
 	jboolean jbool = (*jniEnv)->CallBooleanMethod(jniEnv, atk_selection, jmid, (jint)i);
@@ -169,6 +236,7 @@ jaw_selection_remove_selection (AtkSelection *selection, gint i)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "remove_selection", "(I)Z");
 	jboolean jbool = (*jniEnv)->CallBooleanMethod(jniEnv, atk_selection, jmid, (jint)i);
 	(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+	jaw_selection_invalidate(jaw_obj);
 
 	return jbool;
 }
@@ -183,6 +251,7 @@ jaw_selection_select_all_selection (AtkSelection *selection)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkSelection, "select_all_selection", "()Z");
 	jboolean jbool = (*jniEnv)->CallBooleanMethod(jniEnv, atk_selection, jmid);
 	(*jniEnv)->DeleteGlobalRef(jniEnv, atk_selection);
+	jaw_selection_invalidate(jaw_obj);
 
 	return jbool;
 }
@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <stdint.h>
+#include <string.h>
 #include <atk/atk.h>
 #include <glib.h>
 #include "jawimpl.h"
@@ -57,10 +59,38 @@ static void         jaw_table_set_column_header(AtkTable *table, gint column, At
 static void         jaw_table_set_caption(AtkTable *table, AtkObject *caption);
 static void         jaw_table_set_summary(AtkTable *table, AtkObject *summary);
 
+/* A caption, summary or header, with the context keeping its JawImpl alive */
+typedef struct _JawTableObject {
+  JawImpl *jaw_impl;
+  jobject ac;
+} JawTableObject;
+
+/*
+ * Screen readers ask for the dimensions, headers and descriptions again at
+ * each cell they move to, so these are kept until the signals of
+ * AtkWrapper.c tell that they changed, see jaw_table_invalidate().  All of it
+ * is only used from the jaw thread.
+ */
 typedef struct _TableData {
   jobject atk_table;
-  gchar* description;
-  jstring jstrDescription;
+
+  /* JAW_TABLE_* fields holding a value */
+  guint valid;
+  gint n_rows;
+  gint n_columns;
+  JawTableObject caption;
+  JawTableObject summary;
+  /* Index to JawTableObject* or gchar*, cleared instead of flagged */
+  GHashTable *column_headers;
+  GHashTable *row_headers;
+  GHashTable *column_descriptions;
+  GHashTable *row_descriptions;
+  /* Sorted, only kept for JTables which tell when their row selection changes */
+  gint *selected_rows;
+  gint n_selected_rows;
+
+  guint hits[JAW_TABLE_N_FIELDS];
+  guint misses[JAW_TABLE_N_FIELDS];
 } TableData;
 
 #define JAW_GET_TABLE(table, def_ret) \
@@ -101,6 +131,212 @@ jaw_table_interface_init (AtkTableIface *iface, gpointer data)
   iface->remove_column_selection = jaw_table_remove_column_selection;
 }
 
+static void
+jaw_table_object_clear (JNIEnv *env, JawTableObject *object)
+{
+  if (object->jaw_impl != NULL)
+  {
+    g_object_unref(G_OBJECT(object->jaw_impl));
+    object->jaw_impl = NULL;
+  }
+  if (object->ac != NULL)
+  {
+    (*env)->DeleteGlobalRef(env, object->ac);
+    object->ac = NULL;
+  }
+}
+
+static void
+jaw_table_object_free (gpointer p)
+{
+  JawTableObject *object = p;
+  jaw_table_object_clear(jaw_util_get_jni_env(), object);
+  g_free(object);
+}
+
+/* Keep the JawImpl of jac, or NULL, and return it without a new reference */
+static AtkObject*
+jaw_table_object_set (JNIEnv *env, JawTableObject *object, jobject jac)
+{
+  jaw_table_object_clear(env, object);
+  if (jac == NULL)
+    return NULL;
+
+  JawImpl *jaw_impl = jaw_impl_get_instance_from_jaw(env, jac);
+  if (jaw_impl == NULL)
+    return NULL;
+
+  object->ac = (*env)->NewGlobalRef(env, jac);
+  object->jaw_impl = g_object_ref(jaw_impl);
+  return ATK_OBJECT(jaw_impl);
+}
+
+/* Whether field is cached, counting hits and misses */
+static gboolean
+jaw_table_is_cached (TableData *data, guint field)
+{
+  gint i = g_bit_nth_lsf(field, -1);
+  if (data->valid & field)
+  {
+    data->hits[i]++;
+    return TRUE;
+  }
+  data->misses[i]++;
+  return FALSE;
+}
+
+/* Look index up in one of the index tables, counting hits and misses */
+static gboolean
+jaw_table_lookup_index (TableData *data, guint field, GHashTable *table,
+                        gint index, gpointer *value)
+{
+  gint i = g_bit_nth_lsf(field, -1);
+  if (g_hash_table_lookup_extended(table, GINT_TO_POINTER(index), NULL, value))
+  {
+    data->hits[i]++;
+    return TRUE;
+  }
+  data->misses[i]++;
+  return FALSE;
+}
+
+static TableData*
+jaw_table_get_data (JawObject *jaw_obj)
+{
+  return jaw_object_get_interface_data(jaw_obj, INTERFACE_TABLE);
+}
+
+static void
+jaw_table_invalidate_data (JNIEnv *env, TableData *data, guint fields)
+{
+  data->valid &= ~fields;
+  if (fields & JAW_TABLE_CAPTION)
+    jaw_table_object_clear(env, &data->caption);
+  if (fields & JAW_TABLE_SUMMARY)
+    jaw_table_object_clear(env, &data->summary);
+  if (fields & JAW_TABLE_COLUMN_HEADER)
+    g_hash_table_remove_all(data->column_headers);
+  if (fields & JAW_TABLE_ROW_HEADER)
+    g_hash_table_remove_all(data->row_headers);
+  if (fields & JAW_TABLE_COLUMN_DESCRIPTION)
+    g_hash_table_remove_all(data->column_descriptions);
+  if (fields & JAW_TABLE_ROW_DESCRIPTION)
+    g_hash_table_remove_all(data->row_descriptions);
+  if (fields & JAW_TABLE_SELECTED_ROWS)
+  {
+    g_free(data->selected_rows);
+    data->selected_rows = NULL;
+    data->n_selected_rows = 0;
+  }
+}
+
+/* Drop the cached fields, from the jaw thread when their signal is sent */
+void
+jaw_table_invalidate (JawObject *jaw_obj, guint fields)
+{
+  JAW_DEBUG_C("%p, %x", jaw_obj, fields);
+  TableData *data = jaw_table_get_data(jaw_obj);
+  if (data == NULL)
+    return;
+
+  jaw_table_invalidate_data(jaw_util_get_jni_env(), data, fields);
+}
+
+static gboolean
+jaw_table_index_in_range (gpointer key, gpointer value, gpointer user_data)
+{
+  gint index = GPOINTER_TO_INT(key);
+  gint *range = user_data;
+  return index >= range[0] && index <= range[1];
+}
+
+/* Drop the entries of an index table from first to last */
+static void
+jaw_table_remove_indexes (GHashTable *table, gint first, gint last)
+{
+  gint range[2] = { first, last };
+  g_hash_table_foreach_remove(table, jaw_table_index_in_range, range);
+}
+
+/*
+ * n rows were inserted at row, or deleted from it if n is negative.  The
+ * cells are views on their row, so only the row headers and descriptions
+ * from row on are dropped.
+ */
+void
+jaw_table_shift_rows (JawObject *jaw_obj, gint row, gint n)
+{
+  JAW_DEBUG_C("%p, %d, %d", jaw_obj, row, n);
+  TableData *data = jaw_table_get_data(jaw_obj);
+  if (data == NULL)
+    return;
+
+  if (data->valid & JAW_TABLE_N_ROWS)
+    data->n_rows = MAX(data->n_rows + n, 0);
+  jaw_table_invalidate_data(jaw_util_get_jni_env(), data, JAW_TABLE_SELECTED_ROWS);
+  jaw_table_remove_indexes(data->row_headers, row, G_MAXINT);
+  jaw_table_remove_indexes(data->row_descriptions, row, G_MAXINT);
+}
+
+/* Same as jaw_table_shift_rows() for columns */
+void
+jaw_table_shift_columns (JawObject *jaw_obj, gint column, gint n)
+{
+  JAW_DEBUG_C("%p, %d, %d", jaw_obj, column, n);
+  TableData *data = jaw_table_get_data(jaw_obj);
+  if (data == NULL)
+    return;
+
+  if (data->valid & JAW_TABLE_N_COLUMNS)
+    data->n_columns = MAX(data->n_columns + n, 0);
+  jaw_table_remove_indexes(data->column_headers, column, G_MAXINT);
+  jaw_table_remove_indexes(data->column_descriptions, column, G_MAXINT);
+}
+
+/* The cells of the given rows and columns changed, or the columns moved */
+void
+jaw_table_update_cells (JawObject *jaw_obj,
+                        gint first_row,
+                        gint last_row,
+                        gint first_column,
+                        gint last_column)
+{
+  JAW_DEBUG_C("%p, %d, %d, %d, %d", jaw_obj, first_row, last_row, first_column, last_column);
+  TableData *data = jaw_table_get_data(jaw_obj);
+  if (data == NULL)
+    return;
+
+  jaw_table_remove_indexes(data->row_headers, first_row, last_row);
+  jaw_table_remove_indexes(data->row_descriptions, first_row, last_row);
+  jaw_table_remove_indexes(data->column_headers, first_column, last_column);
+  jaw_table_remove_indexes(data->column_descriptions, first_column, last_column);
+}
+
+/*
+ * Every row moved, now n_rows of them.  Returns whether that can be the
+ * row count known before, which sorted tables don't keep, in which case
+ * the columns are kept.
+ */
+gboolean
+jaw_table_reorder_rows (JawObject *jaw_obj, gint n_rows)
+{
+  JAW_DEBUG_C("%p, %d", jaw_obj, n_rows);
+  TableData *data = jaw_table_get_data(jaw_obj);
+  if (data == NULL)
+    return FALSE;
+
+  if ((data->valid & JAW_TABLE_N_ROWS) && data->n_rows != n_rows)
+  {
+    jaw_table_invalidate_data(jaw_util_get_jni_env(), data, JAW_TABLE_ALL);
+    return FALSE;
+  }
+
+  jaw_table_invalidate_data(jaw_util_get_jni_env(), data,
+                            JAW_TABLE_ROW_HEADER | JAW_TABLE_ROW_DESCRIPTION |
+                            JAW_TABLE_SELECTED_ROWS);
+  return TRUE;
+}
+
 gpointer
 jaw_table_data_init (jobject ac)
 {
@@ -117,6 +353,11 @@ jaw_table_data_init (jobject ac)
   jobject jatk_table = (*env)->CallStaticObjectMethod(env, classTable, jmid, ac);
   data->atk_table = (*env)->NewGlobalRef(env, jatk_table);
 
+  data->column_headers = g_hash_table_new_full(NULL, NULL, NULL, jaw_table_object_free);
+  data->row_headers = g_hash_table_new_full(NULL, NULL, NULL, jaw_table_object_free);
+  data->column_descriptions = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+  data->row_descriptions = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+
   return data;
 }
 
@@ -129,19 +370,125 @@ jaw_table_data_finalize (gpointer p)
 
   if (data && data->atk_table)
   {
-    if (data->description != NULL)
-    {
-      (*env)->ReleaseStringUTFChars(env, data->jstrDescription, data->description);
-      (*env)->DeleteGlobalRef(env, data->jstrDescription);
-      data->jstrDescription = NULL;
-      data->description = NULL;
-    }
+    gint i;
+    for (i = 0; i < JAW_TABLE_N_FIELDS; i++)
+      JAW_DEBUG_I("field %d: %u hits, %u misses", i, data->hits[i], data->misses[i]);
+
+    jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
+    jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "unlisten", "()V");
+    (*env)->CallVoidMethod(env, data->atk_table, jmid);
+
+    jaw_table_invalidate_data(env, data, JAW_TABLE_ALL);
+    g_hash_table_destroy(data->column_headers);
+    g_hash_table_destroy(data->row_headers);
+    g_hash_table_destroy(data->column_descriptions);
+    g_hash_table_destroy(data->row_descriptions);
 
     (*env)->DeleteGlobalRef(env, data->atk_table);
     data->atk_table = NULL;
   }
 }
 
+/* Longest row read at once, to stay well below the size of the cell pool */
+#define JAW_TABLE_READ_AHEAD_MAX_COLUMNS 64
+
+/*
+ * Screen readers moving to a row ask for each of its cells, then for their
+ * name and states, and for the column headers.  All of it is read at once
+ * with AtkTable.get_row_snapshot, the cells put in the cell pool with their
+ * name and states read ahead, and the headers cached.  Only done for tables
+ * whose cells are pooled, since others keep their cells anyway.
+ */
+static gboolean
+jaw_table_read_row (JNIEnv *env, JawObject *jaw_obj, TableData *data, gint row)
+{
+  JAW_DEBUG_C("%p, %p, %p, %d", env, jaw_obj, data, row);
+  JawImpl *container = (JawImpl*)jaw_obj;
+  if (!jaw_impl_has_cell_pool(env, container))
+    return FALSE;
+
+  gint n_columns = jaw_table_get_n_columns(ATK_TABLE(jaw_obj));
+  if (n_columns <= 0 || n_columns > JAW_TABLE_READ_AHEAD_MAX_COLUMNS)
+    return FALSE;
+
+  jobject atk_table = (*env)->NewGlobalRef(env, data->atk_table);
+  if (!atk_table) {
+    JAW_DEBUG_I("atk_table == NULL");
+    return FALSE;
+  }
+
+  jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
+  jmethodID jmid = (*env)->GetMethodID(env,
+                                       classAtkTable,
+                                       "get_row_snapshot",
+                                       "(II)Lorg/GNOME/Accessibility/AtkTable$RowSnapshot;");
+  jobject jsnapshot = (*env)->CallObjectMethod(env, atk_table, jmid, (jint)row, (jint)row);
+  (*env)->DeleteGlobalRef(env, atk_table);
+
+  if (!jsnapshot)
+    return FALSE;
+
+  jclass classSnapshot = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable$RowSnapshot");
+  jfieldID jfidColumns = (*env)->GetFieldID(env, classSnapshot, "n_columns", "I");
+  jfieldID jfidCells = (*env)->GetFieldID(env, classSnapshot, "cells", "[Ljavax/accessibility/AccessibleContext;");
+  jfieldID jfidInstances = (*env)->GetFieldID(env, classSnapshot, "instances", "[J");
+  jfieldID jfidNames = (*env)->GetFieldID(env, classSnapshot, "names", "[Ljava/lang/String;");
+  jfieldID jfidStates = (*env)->GetFieldID(env, classSnapshot, "states", "[[Ljavax/accessibility/AccessibleState;");
+  jfieldID jfidHeaders = (*env)->GetFieldID(env, classSnapshot, "headers", "[Ljavax/accessibility/AccessibleContext;");
+  jfieldID jfidHeaderInstances = (*env)->GetFieldID(env, classSnapshot, "header_instances", "[J");
+  jfieldID jfidHeaderNames = (*env)->GetFieldID(env, classSnapshot, "header_names", "[Ljava/lang/String;");
+
+  jint jn_columns = (*env)->GetIntField(env, jsnapshot, jfidColumns);
+  jobjectArray jcells = (*env)->GetObjectField(env, jsnapshot, jfidCells);
+  jlongArray jinstances = (*env)->GetObjectField(env, jsnapshot, jfidInstances);
+  jobjectArray jnames = (*env)->GetObjectField(env, jsnapshot, jfidNames);
+  jobjectArray jstates = (*env)->GetObjectField(env, jsnapshot, jfidStates);
+  jobjectArray jheaders = (*env)->GetObjectField(env, jsnapshot, jfidHeaders);
+  jlongArray jheader_instances = (*env)->GetObjectField(env, jsnapshot, jfidHeaderInstances);
+  jobjectArray jheader_names = (*env)->GetObjectField(env, jsnapshot, jfidHeaderNames);
+
+  jlong *instances = (*env)->GetLongArrayElements(env, jinstances, NULL);
+  jlong *header_instances = (*env)->GetLongArrayElements(env, jheader_instances, NULL);
+  jaw_object_drop_read_ahead();
+  gint column;
+  for (column = 0; column < jn_columns; column++)
+  {
+    JawImpl *cell = (JawImpl*) (uintptr_t) instances[column];
+    if (cell != NULL)
+    {
+      jobject jcell = (*env)->GetObjectArrayElement(env, jcells, column);
+      jstring jname = (*env)->GetObjectArrayElement(env, jnames, column);
+      jobjectArray jcell_states = (*env)->GetObjectArrayElement(env, jstates, column);
+      jaw_object_set_read_ahead(JAW_OBJECT(cell), env, jname, jcell_states);
+      jaw_impl_pool_cell(env, container, row, column, cell, jcell);
+      (*env)->DeleteLocalRef(env, jcell_states);
+      (*env)->DeleteLocalRef(env, jname);
+      (*env)->DeleteLocalRef(env, jcell);
+    }
+
+    if (g_hash_table_contains(data->column_headers, GINT_TO_POINTER(column)))
+      continue;
+
+    JawTableObject *header = g_new0(JawTableObject, 1);
+    JawImpl *header_impl = (JawImpl*) (uintptr_t) header_instances[column];
+    if (header_impl != NULL)
+    {
+      jobject jheader = (*env)->GetObjectArrayElement(env, jheaders, column);
+      jstring jheader_name = (*env)->GetObjectArrayElement(env, jheader_names, column);
+      header->ac = (*env)->NewGlobalRef(env, jheader);
+      header->jaw_impl = g_object_ref(header_impl);
+      jaw_object_set_read_ahead(JAW_OBJECT(header_impl), env, jheader_name, NULL);
+      (*env)->DeleteLocalRef(env, jheader_name);
+      (*env)->DeleteLocalRef(env, jheader);
+    }
+    g_hash_table_insert(data->column_headers, GINT_TO_POINTER(column), header);
+  }
+  (*env)->ReleaseLongArrayElements(env, jheader_instances, header_instances, JNI_ABORT);
+  (*env)->ReleaseLongArrayElements(env, jinstances, instances, JNI_ABORT);
+
+  return TRUE;
+}
+
 static AtkObject*
 jaw_table_ref_at (AtkTable *table, gint	row, gint column)
 {
@@ -153,6 +500,18 @@ jaw_table_ref_at (AtkTable *table, gint	row, gint column)
   }
   TableData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_TABLE);
   JNIEnv *env = jaw_util_get_jni_env();
+
+  AtkObject *cell = jaw_impl_ref_cell(env, (JawImpl*)jaw_obj, row, column);
+  if (cell != NULL)
+    return cell;
+
+  if (jaw_table_read_row(env, jaw_obj, data, row))
+  {
+    cell = jaw_impl_ref_cell(env, (JawImpl*)jaw_obj, row, column);
+    if (cell != NULL)
+      return cell;
+  }
+
   jobject atk_table = (*env)->NewGlobalRef(env, data->atk_table);
   if (!atk_table) {
     JAW_DEBUG_I("atk_table == NULL");
@@ -170,12 +529,7 @@ jaw_table_ref_at (AtkTable *table, gint	row, gint column)
   if (!jac)
     return NULL;
 
-  JawImpl* jaw_impl = jaw_impl_get_instance_from_jaw( env, jac );
-
-  if (G_OBJECT(jaw_impl) != NULL)
-    g_object_ref(G_OBJECT(jaw_impl));
-
-  return ATK_OBJECT(jaw_impl);
+  return jaw_impl_ref_cell_instance(env, (JawImpl*)jaw_obj, row, column, jac);
 }
 
 static gint
@@ -226,12 +580,29 @@ jaw_table_get_n_columns	(AtkTable *table)
   JAW_DEBUG_C("%p", table);
   JAW_GET_TABLE(table, 0);
 
+  if (jaw_table_is_cached(data, JAW_TABLE_N_COLUMNS))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return data->n_columns;
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_n_columns", "()I");
   jint jcolumns = (*env)->CallIntMethod(env, atk_table, jmid);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  return (gint)jcolumns;
+  data->n_columns = (gint)jcolumns;
+  data->valid |= JAW_TABLE_N_COLUMNS;
+  return data->n_columns;
+}
+
+/* Whether the rows go through a RowSorter, reading a field of AtkTable */
+static gboolean
+jaw_table_is_row_sorted (JNIEnv *env, jobject atk_table)
+{
+  jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
+  jfieldID jfid = (*env)->GetFieldID(env, classAtkTable, "_row_sorted", "Z");
+  return (*env)->GetBooleanField(env, atk_table, jfid) == JNI_TRUE;
 }
 
 static gint
@@ -240,12 +611,24 @@ jaw_table_get_n_rows (AtkTable *table)
   JAW_DEBUG_C("%p", table);
   JAW_GET_TABLE(table, 0);
 
+  gboolean sorted = jaw_table_is_row_sorted(env, atk_table);
+  if (!sorted && jaw_table_is_cached(data, JAW_TABLE_N_ROWS))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return data->n_rows;
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_n_rows", "()I");
   jint jrows = (*env)->CallIntMethod(env, atk_table, jmid);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  return (gint)jrows;
+  data->n_rows = (gint)jrows;
+  if (sorted)
+    data->valid &= ~JAW_TABLE_N_ROWS;
+  else
+    data->valid |= JAW_TABLE_N_ROWS;
+  return data->n_rows;
 }
 
 static gint
@@ -282,6 +665,13 @@ jaw_table_get_caption (AtkTable	*table)
   JAW_DEBUG_C("%p", table);
   JAW_GET_TABLE(table, NULL);
 
+  /* get_caption returns with transfer: none */
+  if (jaw_table_is_cached(data, JAW_TABLE_CAPTION))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return ATK_OBJECT(data->caption.jaw_impl);
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env,
                                        classAtkTable,
@@ -291,13 +681,8 @@ jaw_table_get_caption (AtkTable	*table)
   jobject jac = (*env)->CallObjectMethod(env, atk_table, jmid);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (!jac)
-    return NULL;
-
-  JawImpl* jaw_impl = jaw_impl_get_instance_from_jaw( env, jac );
-  /* get_caption returns with transfer: none */
-
-  return ATK_OBJECT(jaw_impl);
+  data->valid |= JAW_TABLE_CAPTION;
+  return jaw_table_object_set(env, &data->caption, jac);
 }
 
 static const gchar*
@@ -306,21 +691,22 @@ jaw_table_get_column_description (AtkTable *table, gint	column)
   JAW_DEBUG_C("%p, %d", table, column);
   JAW_GET_TABLE(table, NULL);
 
+  gpointer description;
+  if (jaw_table_lookup_index(data, JAW_TABLE_COLUMN_DESCRIPTION, data->column_descriptions,
+                             column, &description))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return description;
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_column_description", "(I)Ljava/lang/String;");
   jstring jstr = (*env)->CallObjectMethod(env, atk_table, jmid, (jint)column);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (data->description != NULL)
-  {
-    (*env)->ReleaseStringUTFChars(env, data->jstrDescription, data->description);
-    (*env)->DeleteGlobalRef(env, data->jstrDescription);
-  }
-
-  data->jstrDescription = (*env)->NewGlobalRef(env, jstr);
-  data->description = (gchar*)(*env)->GetStringUTFChars(env, data->jstrDescription, NULL);
-
-  return data->description;
+  description = jaw_util_get_string_utf8(env, jstr);
+  g_hash_table_insert(data->column_descriptions, GINT_TO_POINTER(column), description);
+  return description;
 }
 
 static const gchar*
@@ -329,21 +715,22 @@ jaw_table_get_row_description (AtkTable *table, gint row)
   JAW_DEBUG_C("%p, %d", table, row);
   JAW_GET_TABLE(table, NULL);
 
+  gpointer description;
+  if (jaw_table_lookup_index(data, JAW_TABLE_ROW_DESCRIPTION, data->row_descriptions,
+                             row, &description))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return description;
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_row_description", "(I)Ljava/lang/String;");
   jstring jstr = (*env)->CallObjectMethod(env, atk_table, jmid, (jint)row);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (data->description != NULL)
-  {
-    (*env)->ReleaseStringUTFChars(env, data->jstrDescription, data->description);
-    (*env)->DeleteGlobalRef(env, data->jstrDescription);
-  }
-
-  data->jstrDescription = (*env)->NewGlobalRef(env, jstr);
-  data->description = (gchar*)(*env)->GetStringUTFChars(env, data->jstrDescription, NULL);
-
-  return data->description;
+  description = jaw_util_get_string_utf8(env, jstr);
+  g_hash_table_insert(data->row_descriptions, GINT_TO_POINTER(row), description);
+  return description;
 }
 
 static AtkObject*
@@ -352,18 +739,22 @@ jaw_table_get_column_header (AtkTable *table, gint column)
   JAW_DEBUG_C("%p, %d", table, column);
   JAW_GET_TABLE(table, NULL);
 
+  /* get_column_header returns with transfer: none */
+  gpointer value;
+  if (jaw_table_lookup_index(data, JAW_TABLE_COLUMN_HEADER, data->column_headers, column, &value))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return ATK_OBJECT(((JawTableObject*)value)->jaw_impl);
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_column_header", "(I)Ljavax/accessibility/AccessibleContext;");
   jobject jac = (*env)->CallObjectMethod(env, atk_table, jmid, (jint)column);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (!jac)
-    return NULL;
-
-  JawImpl* jaw_impl = jaw_impl_get_instance_from_jaw( env, jac );
-  /* get_column_header returns with transfer: none */
-
-  return ATK_OBJECT(jaw_impl);
+  JawTableObject *header = g_new0(JawTableObject, 1);
+  g_hash_table_insert(data->column_headers, GINT_TO_POINTER(column), header);
+  return jaw_table_object_set(env, header, jac);
 }
 
 static AtkObject*
@@ -372,18 +763,22 @@ jaw_table_get_row_header (AtkTable *table, gint row)
   JAW_DEBUG_C("%p, %d", table, row);
   JAW_GET_TABLE(table, NULL);
 
+  /* get_row_header returns with transfer: none */
+  gpointer value;
+  if (jaw_table_lookup_index(data, JAW_TABLE_ROW_HEADER, data->row_headers, row, &value))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return ATK_OBJECT(((JawTableObject*)value)->jaw_impl);
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_row_header", "(I)Ljavax/accessibility/AccessibleContext;");
   jobject jac = (*env)->CallObjectMethod(env, atk_table, jmid, (jint)row);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (!jac)
-    return NULL;
-
-  JawImpl* jaw_impl = jaw_impl_get_instance_from_jaw( env, jac );
-  /* get_row_header returns with transfer: none */
-
-  return ATK_OBJECT(jaw_impl);
+  JawTableObject *header = g_new0(JawTableObject, 1);
+  g_hash_table_insert(data->row_headers, GINT_TO_POINTER(row), header);
+  return jaw_table_object_set(env, header, jac);
 }
 
 static AtkObject*
@@ -392,20 +787,22 @@ jaw_table_get_summary (AtkTable *table)
   JAW_DEBUG_C("%p", table);
   JAW_GET_TABLE(table, NULL);
 
+  /* FIXME: get_summary is documented to return with transfer full,
+   * but used with transfer null in atk_object_real_get_property,
+   * see https://gitlab.gnome.org/GNOME/at-spi2-core/-/issues/207 */
+  if (jaw_table_is_cached(data, JAW_TABLE_SUMMARY))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return ATK_OBJECT(data->summary.jaw_impl);
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_summary", "()Ljavax/accessibility/AccessibleContext;");
   jobject jac = (*env)->CallObjectMethod(env, atk_table, jmid);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (!jac)
-    return NULL;
-
-  JawImpl* jaw_impl = jaw_impl_get_instance_from_jaw( env, jac );
-  /* FIXME: get_summary is documented to return with transfer full,
-   * but used with transfer null in atk_object_real_get_property,
-   * see https://gitlab.gnome.org/GNOME/at-spi2-core/-/issues/207 */
-
-  return ATK_OBJECT(jaw_impl);
+  data->valid |= JAW_TABLE_SUMMARY;
+  return jaw_table_object_set(env, &data->summary, jac);
 }
 
 static gint
@@ -422,18 +819,34 @@ jaw_table_get_selected_columns (AtkTable *table, gint **selected)
   if (!jcolumnArray)
     return 0;
 
-  jsize length = (*env)->GetArrayLength(env, jcolumnArray);
-  jint *jcolumns = (*env)->GetIntArrayElements(env, jcolumnArray, NULL);
-  gint *columns = g_new(gint, length);
+  gint length;
+  *selected = jaw_util_get_sorted_ints(env, jcolumnArray, &length);
 
-  gint i;
-  for (i = 0; i < length; i++) {
-    columns[i] = (gint)jcolumns[i];
-  }
+  return length;
+}
 
-  (*env)->ReleaseIntArrayElements(env, jcolumnArray, jcolumns, JNI_ABORT);
+/*
+ * Whether the selected rows are known, reading them if they can be kept:
+ * Swing only tells about row selection changes, and for JTables.
+ */
+static gboolean
+jaw_table_get_selected (JNIEnv *env, JawObject *jaw_obj, TableData *data, jobject atk_table)
+{
+  if (jaw_table_is_cached(data, JAW_TABLE_SELECTED_ROWS))
+    return TRUE;
+
+  if (atk_object_get_role(ATK_OBJECT(jaw_obj)) != ATK_ROLE_TABLE)
+    return FALSE;
+
+  jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
+  jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_selected_rows", "()[I");
+  jintArray jrowArray = (*env)->CallObjectMethod(env, atk_table, jmid);
+  if (!jrowArray)
+    return FALSE;
 
-  return (gint)length;
+  data->selected_rows = jaw_util_get_sorted_ints(env, jrowArray, &data->n_selected_rows);
+  data->valid |= JAW_TABLE_SELECTED_ROWS;
+  return TRUE;
 }
 
 static gint
@@ -442,26 +855,23 @@ jaw_table_get_selected_rows (AtkTable *table, gint **selected)
   JAW_DEBUG_C("%p, %p", table, selected);
   JAW_GET_TABLE(table, 0);
 
+  if (jaw_table_get_selected(env, jaw_obj, data, atk_table))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    *selected = g_new(gint, data->n_selected_rows);
+    memcpy(*selected, data->selected_rows, data->n_selected_rows * sizeof(gint));
+    return data->n_selected_rows;
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "get_selected_rows", "()[I");
   jintArray jrowArray = (*env)->CallObjectMethod(env, atk_table, jmid);
   (*env)->DeleteGlobalRef(env, atk_table);
 
-  if (!jrowArray)
-    return 0;
-
-  jsize length = (*env)->GetArrayLength(env, jrowArray);
-  jint *jrows = (*env)->GetIntArrayElements(env, jrowArray, NULL);
-  gint *rows = g_new(gint, length);
+  gint length;
+  *selected = jaw_util_get_sorted_ints(env, jrowArray, &length);
 
-  gint i;
-  for (i = 0; i < length; i++) {
-    rows[i] = (gint)jrows[i];
-  }
-
-  (*env)->ReleaseIntArrayElements(env, jrowArray, jrows, JNI_ABORT);
-
-  return (gint)length;
+  return length;
 }
 
 static gboolean
@@ -483,6 +893,12 @@ jaw_table_is_row_selected (AtkTable *table, gint row)
   JAW_DEBUG_C("%p, %d", table, row);
   JAW_GET_TABLE(table, FALSE);
 
+  if (jaw_table_get_selected(env, jaw_obj, data, atk_table))
+  {
+    (*env)->DeleteGlobalRef(env, atk_table);
+    return jaw_util_sorted_ints_contain(data->selected_rows, data->n_selected_rows, row);
+  }
+
   jclass classAtkTable = (*env)->FindClass(env, "org/GNOME/Accessibility/AtkTable");
   jmethodID jmid = (*env)->GetMethodID(env, classAtkTable, "is_row_selected", "(I)Z");
   jboolean jselected = (*env)->CallBooleanMethod(env, atk_table, jmid, (jint)row);
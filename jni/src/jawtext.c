@@ -17,10 +17,13 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <stdint.h>
+#include <string.h>
 #include <atk/atk.h>
 #include <glib.h>
 #include "jawimpl.h"
 #include "jawutil.h"
+#include "jawtextmirror.h"
 
 static gchar* jaw_text_get_text(AtkText *text,
                                 gint start_offset,
@@ -88,12 +91,120 @@ static gboolean jaw_text_set_selection(AtkText *text,
 
 static gboolean jaw_text_set_caret_offset(AtkText *text, gint offset);
 
+static AtkAttributeSet* jaw_text_get_run_attributes(AtkText *text,
+                                                    gint offset,
+                                                    gint *start_offset,
+                                                    gint *end_offset);
+
+static AtkAttributeSet* jaw_text_get_default_attributes(AtkText *text);
+
+static gchar* jaw_text_get_string_at_offset(AtkText *text,
+                                            gint offset,
+                                            AtkTextGranularity granularity,
+                                            gint *start_offset,
+                                            gint *end_offset);
+
+static AtkTextRange** jaw_text_get_bounded_ranges(AtkText *text,
+                                                  AtkTextRectangle *rect,
+                                                  AtkCoordType coord_type,
+                                                  AtkTextClipType x_clip_type,
+                                                  AtkTextClipType y_clip_type);
+
+/* Lines whose character bounds are kept */
+#define JAW_TEXT_N_LINE_EXTENTS 4
+
 typedef struct _TextData {
   jobject atk_text;
   gchar* text;
   jstring jstrText;
+  JawTextMirror *mirror;
+  /* Attribute runs, valid while runs_serial is AtkText._attributes_serial */
+  GArray *runs;
+  GHashTable *run_sets;
+  jint runs_serial;
+  /* Valid while caret_serial is AtkText._caret_serial, for caret_flags */
+  jint caret_serial;
+  guint caret_flags;
+  gint caret;
+  gint n_selections;
+  gchar *selection;
+  gint selection_start;
+  gint selection_end;
+  /* Valid while count_serial is AtkText._text_serial, if count_valid */
+  jint count_serial;
+  gboolean count_valid;
+  gint count;
+  /*
+   * LINE or SENTENCE ranges read ahead, valid while read_ahead_serial is
+   * AtkText._text_serial and read_ahead_layout the layout serial of
+   * jawcomponent.c, since lines wrap again when the text is resized
+   */
+  GArray *read_ahead;
+  AtkTextBoundary read_ahead_boundary;
+  jint read_ahead_serial;
+  gint read_ahead_layout;
+  /*
+   * Origin of the component for each AtkCoordType set in origins_valid,
+   * and its size, valid while origins_layout is the layout serial of
+   * jawcomponent.c, which also moves on when a window moves
+   */
+  guint origins_valid;
+  gint origins_layout;
+  gint origins[6];
+  gint component_width;
+  gint component_height;
+  /* Last range returned by get_text_at_offset, to notice reading in order */
+  AtkTextBoundary last_boundary;
+  gint last_start;
+  gint last_end;
+  guint n_sequential;
+  /* Most recently used first, see jaw_text_get_line_extents() */
+  struct _JawTextLineExtents *line_extents[JAW_TEXT_N_LINE_EXTENTS];
 }TextData;
 
+/*
+ * Character bounds of part of a line, relative to the component.  They
+ * stay valid while AtkText._attributes_serial and the size of the
+ * component don't change, and the origin is added on each query.
+ */
+typedef struct _JawTextLineExtents {
+  gint start;
+  gint end;
+  jint serial;
+  gint component_width;
+  gint component_height;
+  /* x, y, width, height of each character, width -1 if unknown */
+  gint *rects;
+} JawTextLineExtents;
+
+typedef struct _JawTextSegment {
+  gint start;
+  gint end;
+  gchar *text;
+} JawTextSegment;
+
+/* Ranges fetched at once, and reads in order needed before doing so */
+#define JAW_TEXT_READ_AHEAD 32
+#define JAW_TEXT_READ_AHEAD_AFTER 2
+
+enum {
+  JAW_TEXT_CARET        = 1 << 0,
+  JAW_TEXT_N_SELECTIONS = 1 << 1,
+  JAW_TEXT_SELECTION    = 1 << 2
+};
+
+typedef struct _JawTextRun {
+  gint end;
+  /* Owned by run_sets */
+  AtkAttributeSet *attributes;
+} JawTextRun;
+
+/*
+ * The text mirrors are changed from the Swing thread, by
+ * jaw_text_mirror_changed(), and read from ours.
+ */
+static GMutex jaw_text_mirror_mutex;
+
 #define JAW_GET_TEXT(text, def_ret) \
   JAW_GET_OBJ_IFACE(text, INTERFACE_TEXT, TextData, atk_text, jniEnv, atk_text, def_ret)
 
@@ -107,8 +218,8 @@ jaw_text_interface_init (AtkTextIface *iface, gpointer data)
   iface->get_character_at_offset = jaw_text_get_character_at_offset;
   iface->get_text_before_offset = jaw_text_get_text_before_offset;
   iface->get_caret_offset = jaw_text_get_caret_offset;
-  // TODO: iface->get_run_attributes by iterating getCharacterAttribute or using getTextSequenceAt with ATTRIBUTE_RUN
-  // TODO: iface->get_default_attributes
+  iface->get_run_attributes = jaw_text_get_run_attributes;
+  iface->get_default_attributes = jaw_text_get_default_attributes;
   iface->get_character_extents = jaw_text_get_character_extents;
   iface->get_character_count = jaw_text_get_character_count;
   iface->get_offset_at_point = jaw_text_get_offset_at_point;
@@ -120,14 +231,37 @@ jaw_text_interface_init (AtkTextIface *iface, gpointer data)
   iface->set_caret_offset = jaw_text_set_caret_offset;
 
   iface->get_range_extents = jaw_text_get_range_extents;
-  // TODO: iface->get_bounded_ranges from getTextBounds
-  // TODO: iface->get_string_at_offset
+  iface->get_bounded_ranges = jaw_text_get_bounded_ranges;
+  iface->get_string_at_offset = jaw_text_get_string_at_offset;
 
   // TODO: missing java support for:
   // iface->scroll_substring_to
   // iface->scroll_substring_to_point
 }
 
+/*
+ * JAW_TEXT_MIRROR=1 keeps a native copy of the text of each text object,
+ * so that get_text, get_character_at_offset and get_character_count don't
+ * need to go to Java.  JAW_TEXT_MIRROR=2 additionally checks it against the
+ * Java text before every use.
+ */
+static gint
+jaw_text_get_mirror_mode (void)
+{
+  static gsize mode = 0;
+
+  if (g_once_init_enter(&mode))
+  {
+    const gchar *mirror_env = g_getenv("JAW_TEXT_MIRROR");
+    gint value = 0;
+    if (mirror_env != NULL)
+      value = (gint)g_ascii_strtoll(mirror_env, NULL, 10);
+    g_once_init_leave(&mode, (gsize)(CLAMP(value, 0, 2) + 1));
+  }
+
+  return (gint)mode - 1;
+}
+
 gpointer
 jaw_text_data_init (jobject ac)
 {
@@ -144,9 +278,63 @@ jaw_text_data_init (jobject ac)
   jobject jatk_text = (*jniEnv)->CallStaticObjectMethod(jniEnv, classText, jmid, ac);
   data->atk_text = (*jniEnv)->NewGlobalRef(jniEnv, jatk_text);
 
+  if (data->atk_text != NULL && jaw_text_get_mirror_mode() > 0)
+  {
+    jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classText, "_mirror", "J");
+    data->mirror = jaw_text_mirror_new();
+    (*jniEnv)->SetLongField(jniEnv, data->atk_text, jfid, (jlong)(uintptr_t)data->mirror);
+  }
+
   return data;
 }
 
+static void
+jaw_text_free_runs (TextData *data)
+{
+  JAW_DEBUG_C("%p", data);
+  if (data->runs != NULL)
+  {
+    g_array_free(data->runs, TRUE);
+    data->runs = NULL;
+  }
+  if (data->run_sets != NULL)
+  {
+    g_hash_table_destroy(data->run_sets);
+    data->run_sets = NULL;
+  }
+}
+
+static void
+jaw_text_free_read_ahead (TextData *data)
+{
+  JAW_DEBUG_C("%p", data);
+  if (data->read_ahead == NULL)
+    return;
+
+  guint i;
+  for (i = 0; i < data->read_ahead->len; i++)
+    g_free(g_array_index(data->read_ahead, JawTextSegment, i).text);
+  g_array_free(data->read_ahead, TRUE);
+  data->read_ahead = NULL;
+}
+
+static void
+jaw_text_free_line_extents (TextData *data)
+{
+  JAW_DEBUG_C("%p", data);
+  guint i;
+
+  for (i = 0; i < JAW_TEXT_N_LINE_EXTENTS; i++)
+  {
+    if (data->line_extents[i] != NULL)
+    {
+      g_free(data->line_extents[i]->rects);
+      g_free(data->line_extents[i]);
+      data->line_extents[i] = NULL;
+    }
+  }
+}
+
 void
 jaw_text_data_finalize (gpointer p)
 {
@@ -156,6 +344,29 @@ jaw_text_data_finalize (gpointer p)
 
   if (data && data->atk_text)
   {
+    if (data->mirror != NULL)
+    {
+      jclass classText = (*jniEnv)->FindClass(jniEnv,
+                                              "org/GNOME/Accessibility/AtkText");
+      jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classText, "_mirror", "J");
+      g_mutex_lock(&jaw_text_mirror_mutex);
+      (*jniEnv)->SetLongField(jniEnv, data->atk_text, jfid, (jlong)0);
+      g_mutex_unlock(&jaw_text_mirror_mutex);
+      jaw_text_mirror_free(data->mirror);
+      data->mirror = NULL;
+    }
+
+    jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                               "org/GNOME/Accessibility/AtkText");
+    jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkText, "unlisten", "()V");
+    (*jniEnv)->CallVoidMethod(jniEnv, data->atk_text, jmid);
+
+    jaw_text_free_runs(data);
+    jaw_text_free_read_ahead(data);
+    jaw_text_free_line_extents(data);
+    g_free(data->selection);
+    data->selection = NULL;
+
     if (data->text != NULL)
     {
       (*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrText, data->text);
@@ -178,11 +389,204 @@ jaw_text_get_gtext_from_jstr (JNIEnv *jniEnv, jstring jstr)
     return NULL;
   }
 
-  gchar* tmp_text = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, jstr, NULL);
-  gchar* text = g_strdup(tmp_text);
-  (*jniEnv)->ReleaseStringUTFChars(jniEnv, jstr, tmp_text);
+  return jaw_util_get_string_utf8(jniEnv, jstr);
+}
+
+/* Called from AtkText on the Swing thread for every change of the text */
+void
+jaw_text_mirror_changed (JNIEnv *jniEnv,
+                         jobject jatk_text,
+                         jint position,
+                         jint deleted,
+                         jstring jinserted,
+                         jint count)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %p, %d", jniEnv, jatk_text, position, deleted, jinserted, count);
+  jclass classText = (*jniEnv)->FindClass(jniEnv,
+                                          "org/GNOME/Accessibility/AtkText");
+  jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classText, "_mirror", "J");
+
+  jsize n_inserted = 0;
+  const jchar *inserted = NULL;
+  if (jinserted != NULL)
+  {
+    n_inserted = (*jniEnv)->GetStringLength(jniEnv, jinserted);
+    inserted = (*jniEnv)->GetStringChars(jniEnv, jinserted, NULL);
+  }
+
+  g_mutex_lock(&jaw_text_mirror_mutex);
+  JawTextMirror *mirror = (JawTextMirror*)(uintptr_t)(*jniEnv)->GetLongField(jniEnv, jatk_text, jfid);
+  if (mirror != NULL)
+  {
+    if (position < 0 ||
+        !jaw_text_mirror_delete(mirror, position, deleted) ||
+        !jaw_text_mirror_insert(mirror, position, (const gunichar2*)inserted, n_inserted) ||
+        jaw_text_mirror_get_length(mirror) != count)
+      jaw_text_mirror_invalidate(mirror);
+  }
+  g_mutex_unlock(&jaw_text_mirror_mutex);
+
+  if (inserted != NULL)
+    (*jniEnv)->ReleaseStringChars(jniEnv, jinserted, inserted);
+}
+
+/*
+ * The mirror is in UTF-16 units while ATK offsets are in characters, so it
+ * can only answer while the text has no surrogates.
+ */
+static JawTextMirror*
+jaw_text_mirror_check_offsets (JawTextMirror *mirror)
+{
+  if (!jaw_text_mirror_has_surrogates(mirror))
+    return mirror;
+  g_mutex_unlock(&jaw_text_mirror_mutex);
+  return NULL;
+}
+
+/*
+ * Returns the mirror of the text with jaw_text_mirror_mutex held, filling
+ * it first if needed, or NULL if the query has to go to Java.
+ */
+static JawTextMirror*
+jaw_text_lock_mirror (JNIEnv *jniEnv, TextData *data, jobject atk_text)
+{
+  JAW_DEBUG_C("%p, %p, %p", jniEnv, data, atk_text);
+  JawTextMirror *mirror = data->mirror;
+  if (mirror == NULL)
+    return NULL;
+
+  g_mutex_lock(&jaw_text_mirror_mutex);
+  gboolean valid = jaw_text_mirror_is_valid(mirror);
+  guint serial = jaw_text_mirror_get_serial(mirror);
+  if (valid && jaw_text_get_mirror_mode() < 2)
+    return jaw_text_mirror_check_offsets(mirror);
+  g_mutex_unlock(&jaw_text_mirror_mutex);
+
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  if (valid)
+  {
+    jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                            classAtkText,
+                                            "get_text_hash",
+                                            "()I");
+    jint jhash = (*jniEnv)->CallIntMethod(jniEnv, atk_text, jmid);
+
+    g_mutex_lock(&jaw_text_mirror_mutex);
+    if (jaw_text_mirror_get_serial(mirror) != serial)
+    {
+      /* Changed meanwhile, we can't tell */
+      g_mutex_unlock(&jaw_text_mirror_mutex);
+      return NULL;
+    }
+    if ((gint32)jhash == jaw_text_mirror_get_hash(mirror))
+      return jaw_text_mirror_check_offsets(mirror);
+
+    g_warning("jaw_text_lock_mirror: text mirror out of sync, refilling it");
+    jaw_text_mirror_invalidate(mirror);
+    serial = jaw_text_mirror_get_serial(mirror);
+    g_mutex_unlock(&jaw_text_mirror_mutex);
+  }
+
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_text",
+                                          "(II)Ljava/lang/String;");
+  jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_text, jmid, (jint)0, (jint)-1);
+  if (jstr == NULL)
+    return NULL;
+
+  jsize length = (*jniEnv)->GetStringLength(jniEnv, jstr);
+  gunichar2 *units = g_new(gunichar2, MAX(length, 1));
+  (*jniEnv)->GetStringRegion(jniEnv, jstr, 0, length, (jchar*)units);
+
+  g_mutex_lock(&jaw_text_mirror_mutex);
+  /* Only keep it if no change came in since we asked for it */
+  if (jaw_text_mirror_get_serial(mirror) == serial)
+    jaw_text_mirror_set(mirror, units, length);
+  g_free(units);
 
-  return text;
+  if (jaw_text_mirror_is_valid(mirror))
+    return jaw_text_mirror_check_offsets(mirror);
+  g_mutex_unlock(&jaw_text_mirror_mutex);
+  return NULL;
+}
+
+/*
+ * The caret, selection and character count are cached along with the
+ * serial AtkText bumps when they change.  Reading the serial is a field
+ * access, while asking for them again means going through the Swing thread.
+ * They are also filled from the caret and text signals, which carry them.
+ */
+static jint
+jaw_text_get_serial (JNIEnv *jniEnv, jobject atk_text, const gchar *name)
+{
+  JAW_DEBUG_C("%p, %p, %s", jniEnv, atk_text, name);
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classAtkText, name, "I");
+  return (*jniEnv)->GetIntField(jniEnv, atk_text, jfid);
+}
+
+static void
+jaw_text_check_caret_serial (TextData *data, jint serial)
+{
+  if (data->caret_serial == serial)
+    return;
+
+  data->caret_serial = serial;
+  data->caret_flags = 0;
+  g_free(data->selection);
+  data->selection = NULL;
+}
+
+/*
+ * Only text components have a CaretListener, which also sees the mark
+ * move.  Other texts may not send any event when the caret or the
+ * selection changes, so nothing is kept for them.
+ */
+static void
+jaw_text_check_caret (JNIEnv *jniEnv, jobject atk_text, TextData *data)
+{
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classAtkText, "_caret_listened", "Z");
+  if ((*jniEnv)->GetBooleanField(jniEnv, atk_text, jfid) == JNI_TRUE)
+  {
+    jaw_text_check_caret_serial(data, jaw_text_get_serial(jniEnv, atk_text, "_caret_serial"));
+    return;
+  }
+
+  data->caret_flags = 0;
+  g_free(data->selection);
+  data->selection = NULL;
+}
+
+/* Called from the signal handler, with the state that came with the signal */
+void
+jaw_text_caret_moved (JawObject *jaw_obj, gint caret, jint serial)
+{
+  JAW_DEBUG_C("%p, %d, %d", jaw_obj, caret, serial);
+  TextData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_TEXT);
+  if (data == NULL || serial == -1)
+    return;
+
+  jaw_text_check_caret_serial(data, serial);
+  data->caret = caret;
+  data->caret_flags |= JAW_TEXT_CARET;
+}
+
+void
+jaw_text_count_changed (JawObject *jaw_obj, gint count, jint serial)
+{
+  JAW_DEBUG_C("%p, %d, %d", jaw_obj, count, serial);
+  TextData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_TEXT);
+  if (data == NULL || serial == -1)
+    return;
+
+  data->count_serial = serial;
+  data->count = count;
+  data->count_valid = TRUE;
 }
 
 static gchar*
@@ -191,6 +595,27 @@ jaw_text_get_text (AtkText *text, gint start_offset, gint end_offset)
   JAW_DEBUG_C("%p, %d, %d", text, start_offset, end_offset);
   JAW_GET_TEXT(text, NULL);
 
+  JawTextMirror *mirror = jaw_text_lock_mirror(jniEnv, data, atk_text);
+  if (mirror != NULL)
+  {
+    /* Same clamping as AtkText.getRightStart() and getRightEnd() */
+    gint count = jaw_text_mirror_get_length(mirror);
+    gint start = MAX(start_offset, 0);
+    gint end = end_offset;
+    if (end < -1)
+      end = start;
+    else if (end == -1 || end > count)
+      end = count;
+
+    gchar *str = jaw_text_mirror_get_text(mirror, start, end);
+    g_mutex_unlock(&jaw_text_mirror_mutex);
+    if (str != NULL)
+    {
+      (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+      return str;
+    }
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -214,15 +639,26 @@ jaw_text_get_character_at_offset (AtkText *text, gint offset)
   JAW_DEBUG_C("%p, %d", text, offset);
   JAW_GET_TEXT(text, 0);
 
+  JawTextMirror *mirror = jaw_text_lock_mirror(jniEnv, data, atk_text);
+  if (mirror != NULL)
+  {
+    gunichar character = ' ';
+    if (offset >= 0 && offset < jaw_text_mirror_get_length(mirror))
+      character = jaw_text_mirror_get_char(mirror, offset);
+    g_mutex_unlock(&jaw_text_mirror_mutex);
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return character;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
                                           classAtkText,
-                                          "get_character_at_offset", "(I)C");
-  jchar jcharacter = (*jniEnv)->CallCharMethod(jniEnv,
-                                               atk_text,
-                                               jmid,
-                                               (jint)offset );
+                                          "get_character_at_offset", "(I)I");
+  jint jcharacter = (*jniEnv)->CallIntMethod(jniEnv,
+                                             atk_text,
+                                             jmid,
+                                             (jint)offset );
   (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
 
   return (gunichar)jcharacter;
@@ -258,6 +694,127 @@ static gchar *jaw_text_get_gtext_from_string_seq(JNIEnv *jniEnv,
   return jaw_text_get_gtext_from_jstr(jniEnv, jStr);
 }
 
+/* Whether a START range holds offset, or an END range, which ends at it */
+static gboolean
+jaw_text_segment_holds (JawTextSegment *segment,
+                        AtkTextBoundary boundary_type,
+                        gint offset)
+{
+  if (boundary_type == ATK_TEXT_BOUNDARY_LINE_START ||
+      boundary_type == ATK_TEXT_BOUNDARY_SENTENCE_START)
+    return segment->start <= offset && offset < segment->end;
+  return segment->start < offset && offset <= segment->end;
+}
+
+static void
+jaw_text_fetch_read_ahead (JNIEnv *jniEnv,
+                           TextData *data,
+                           jobject atk_text,
+                           gint offset,
+                           AtkTextBoundary boundary_type,
+                           jint serial)
+{
+  JAW_DEBUG_C("%p, %p, %p, %d, %d, %d", jniEnv, data, atk_text, offset, boundary_type, serial);
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_text_segments_at_offset",
+                                          "(III)[Lorg/GNOME/Accessibility/AtkText$StringSequence;");
+  jobjectArray jsegments = (*jniEnv)->CallObjectMethod(jniEnv,
+                                                       atk_text,
+                                                       jmid,
+                                                       (jint)offset,
+                                                       (jint)boundary_type,
+                                                       (jint)JAW_TEXT_READ_AHEAD);
+  if (jsegments == NULL)
+    return;
+
+  jsize n = (*jniEnv)->GetArrayLength(jniEnv, jsegments);
+  data->read_ahead = g_array_sized_new(FALSE, FALSE, sizeof(JawTextSegment), n);
+  data->read_ahead_boundary = boundary_type;
+  data->read_ahead_serial = serial;
+  data->read_ahead_layout = jaw_component_get_layout_serial();
+
+  jsize i;
+  for (i = 0; i < n; i++)
+  {
+    jobject jStrSeq = (*jniEnv)->GetObjectArrayElement(jniEnv, jsegments, i);
+    JawTextSegment segment;
+    segment.text = jaw_text_get_gtext_from_string_seq(jniEnv, jStrSeq,
+                                                      &segment.start, &segment.end);
+    (*jniEnv)->DeleteLocalRef(jniEnv, jStrSeq);
+    if (segment.text == NULL)
+      break;
+    g_array_append_val(data->read_ahead, segment);
+  }
+}
+
+/*
+ * Say-all reads lines or sentences one after the other, each read starting
+ * where the previous range ended.  Once that is noticed, the next ranges are
+ * fetched in one go and answered from here as long as reading goes on in
+ * order and neither the text nor the layout changes.
+ */
+static gchar*
+jaw_text_read_ahead (JNIEnv *jniEnv,
+                     TextData *data,
+                     jobject atk_text,
+                     gint offset,
+                     AtkTextBoundary boundary_type,
+                     gint *start_offset,
+                     gint *end_offset)
+{
+  JAW_DEBUG_C("%p, %p, %p, %d, %d, %p, %p", jniEnv, data, atk_text, offset, boundary_type, start_offset, end_offset);
+  if (boundary_type != ATK_TEXT_BOUNDARY_LINE_START &&
+      boundary_type != ATK_TEXT_BOUNDARY_LINE_END &&
+      boundary_type != ATK_TEXT_BOUNDARY_SENTENCE_START &&
+      boundary_type != ATK_TEXT_BOUNDARY_SENTENCE_END)
+    return NULL;
+
+  if (boundary_type == data->last_boundary &&
+      offset >= data->last_end && offset <= data->last_end + 1)
+    data->n_sequential++;
+  else
+    data->n_sequential = 0;
+
+  jint serial = jaw_text_get_serial(jniEnv, atk_text, "_text_serial");
+  if (data->read_ahead != NULL &&
+      (data->n_sequential == 0 ||
+       data->read_ahead_serial != serial ||
+       data->read_ahead_boundary != boundary_type ||
+       data->read_ahead_layout != jaw_component_get_layout_serial()))
+    jaw_text_free_read_ahead(data);
+
+  JawTextSegment *segment = NULL;
+  guint i;
+  for (i = 0; data->read_ahead != NULL && i < data->read_ahead->len; i++)
+  {
+    if (jaw_text_segment_holds(&g_array_index(data->read_ahead, JawTextSegment, i),
+                               boundary_type, offset))
+    {
+      segment = &g_array_index(data->read_ahead, JawTextSegment, i);
+      break;
+    }
+  }
+
+  if (segment == NULL && data->n_sequential >= JAW_TEXT_READ_AHEAD_AFTER)
+  {
+    jaw_text_free_read_ahead(data);
+    jaw_text_fetch_read_ahead(jniEnv, data, atk_text, offset, boundary_type, serial);
+    /* The first one is the range at offset */
+    if (data->read_ahead != NULL && data->read_ahead->len > 0)
+      segment = &g_array_index(data->read_ahead, JawTextSegment, 0);
+  }
+
+  if (segment == NULL)
+    return NULL;
+
+  *start_offset = segment->start;
+  *end_offset = segment->end;
+  return g_strdup(segment->text);
+}
+
 static gchar*
 jaw_text_get_text_at_offset (AtkText *text,
                              gint offset,
@@ -267,6 +824,17 @@ jaw_text_get_text_at_offset (AtkText *text,
   JAW_DEBUG_C("%p, %d, %d, %p, %p", text, offset, boundary_type, start_offset, end_offset);
   JAW_GET_TEXT(text, NULL);
 
+  gchar *str = jaw_text_read_ahead(jniEnv, data, atk_text, offset, boundary_type,
+                                   start_offset, end_offset);
+  if (str != NULL)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    data->last_boundary = boundary_type;
+    data->last_start = *start_offset;
+    data->last_end = *end_offset;
+    return str;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -282,10 +850,15 @@ jaw_text_get_text_at_offset (AtkText *text,
 
   if (jStrSeq == NULL)
   {
+    data->last_boundary = -1;
     return NULL;
   }
 
-  return jaw_text_get_gtext_from_string_seq(jniEnv, jStrSeq, start_offset, end_offset);
+  str = jaw_text_get_gtext_from_string_seq(jniEnv, jStrSeq, start_offset, end_offset);
+  data->last_boundary = boundary_type;
+  data->last_start = *start_offset;
+  data->last_end = *end_offset;
+  return str;
 }
 
 static gchar*
@@ -348,12 +921,91 @@ jaw_text_get_text_after_offset (AtkText *text,
   return jaw_text_get_gtext_from_string_seq(jniEnv, jStrSeq, start_offset, end_offset);
 }
 
+/* Boundary whose START ranges are the granularity ranges, -1 if none */
+static gint
+jaw_text_granularity_boundary (AtkTextGranularity granularity)
+{
+  switch (granularity)
+  {
+    case ATK_TEXT_GRANULARITY_CHAR:
+      return ATK_TEXT_BOUNDARY_CHAR;
+    case ATK_TEXT_GRANULARITY_WORD:
+      return ATK_TEXT_BOUNDARY_WORD_START;
+    case ATK_TEXT_GRANULARITY_SENTENCE:
+      return ATK_TEXT_BOUNDARY_SENTENCE_START;
+    case ATK_TEXT_GRANULARITY_LINE:
+      return ATK_TEXT_BOUNDARY_LINE_START;
+    default:
+      return -1;
+  }
+}
+
+static gchar*
+jaw_text_get_string_at_offset (AtkText *text,
+                               gint offset,
+                               AtkTextGranularity granularity,
+                               gint *start_offset,
+                               gint *end_offset)
+{
+  JAW_DEBUG_C("%p, %d, %d, %p, %p", text, offset, granularity, start_offset, end_offset);
+  *start_offset = -1;
+  *end_offset = -1;
+  JAW_GET_TEXT(text, NULL);
+
+  /* Lines and sentences read in order come from the read-ahead ranges */
+  gint boundary_type = jaw_text_granularity_boundary(granularity);
+  gchar *str = NULL;
+  if (boundary_type >= 0)
+    str = jaw_text_read_ahead(jniEnv, data, atk_text, offset, (AtkTextBoundary)boundary_type,
+                              start_offset, end_offset);
+  if (str != NULL)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    data->last_boundary = boundary_type;
+    data->last_start = *start_offset;
+    data->last_end = *end_offset;
+    return str;
+  }
+
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_string_at_offset",
+                                          "(II)Lorg/GNOME/Accessibility/AtkText$StringSequence;");
+  jobject jStrSeq = (*jniEnv)->CallObjectMethod(jniEnv,
+                                                atk_text,
+                                                jmid,
+                                                (jint)offset,
+                                                (jint)granularity);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+
+  if (jStrSeq == NULL)
+  {
+    data->last_boundary = -1;
+    return NULL;
+  }
+
+  str = jaw_text_get_gtext_from_string_seq(jniEnv, jStrSeq, start_offset, end_offset);
+  data->last_boundary = boundary_type;
+  data->last_start = *start_offset;
+  data->last_end = *end_offset;
+  return str;
+}
+
 static gint
 jaw_text_get_caret_offset (AtkText *text)
 {
   JAW_DEBUG_C("%p", text);
   JAW_GET_TEXT(text, 0);
 
+  jaw_text_check_caret(jniEnv, atk_text, data);
+  if (data->caret_flags & JAW_TEXT_CARET)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return data->caret;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -363,9 +1015,141 @@ jaw_text_get_caret_offset (AtkText *text)
   jint joffset = (*jniEnv)->CallIntMethod(jniEnv, atk_text, jmid);
   (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
 
+  data->caret = (gint)joffset;
+  data->caret_flags |= JAW_TEXT_CARET;
   return (gint)joffset;
 }
 
+/* Origin of the component for coords, and its size */
+static gboolean
+jaw_text_get_extents_origin (JNIEnv *jniEnv,
+                             TextData *data,
+                             jobject atk_text,
+                             AtkCoordType coords,
+                             gint *x,
+                             gint *y,
+                             gint *width,
+                             gint *height)
+{
+  JAW_DEBUG_C("%p, %p, %p, %d", jniEnv, data, atk_text, coords);
+  gint layout = jaw_component_get_layout_serial();
+  if (data->origins_layout != layout)
+  {
+    data->origins_valid = 0;
+    data->origins_layout = layout;
+  }
+  if (coords >= 0 && coords < 3 && (data->origins_valid & (1 << coords)))
+  {
+    *x = data->origins[2 * coords];
+    *y = data->origins[2 * coords + 1];
+    *width = data->component_width;
+    *height = data->component_height;
+    return TRUE;
+  }
+
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_extents_origin",
+                                          "(I)Ljava/awt/Rectangle;");
+  jobject jrect = (*jniEnv)->CallObjectMethod(jniEnv, atk_text, jmid, (jint)coords);
+  if (jrect == NULL)
+    return FALSE;
+
+  jaw_util_get_rect_info(jniEnv, jrect, x, y, width, height);
+  (*jniEnv)->DeleteLocalRef(jniEnv, jrect);
+  if (coords >= 0 && coords < 3)
+  {
+    data->origins[2 * coords] = *x;
+    data->origins[2 * coords + 1] = *y;
+    data->component_width = *width;
+    data->component_height = *height;
+    data->origins_valid |= 1 << coords;
+  }
+  return TRUE;
+}
+
+/*
+ * The bounds of the line holding offset, from the cache or else fetched
+ * for the whole line in one call, so that following the caret along a line
+ * only needs the origin of the component.
+ */
+static JawTextLineExtents*
+jaw_text_get_line_extents (JNIEnv *jniEnv,
+                           TextData *data,
+                           jobject atk_text,
+                           gint offset,
+                           gint component_width,
+                           gint component_height)
+{
+  JAW_DEBUG_C("%p, %p, %p, %d, %d, %d", jniEnv, data, atk_text, offset, component_width, component_height);
+  jint serial = jaw_text_get_serial(jniEnv, atk_text, "_attributes_serial");
+  JawTextLineExtents *line = NULL;
+  guint i;
+
+  for (i = 0; i < JAW_TEXT_N_LINE_EXTENTS && data->line_extents[i] != NULL; i++)
+  {
+    JawTextLineExtents *cached = data->line_extents[i];
+    if (cached->serial != serial ||
+        cached->component_width != component_width ||
+        cached->component_height != component_height)
+    {
+      /* Everything else is as old */
+      jaw_text_free_line_extents(data);
+      break;
+    }
+    if (cached->start <= offset && offset < cached->end)
+    {
+      line = cached;
+      break;
+    }
+  }
+
+  if (line == NULL)
+  {
+    jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                               "org/GNOME/Accessibility/AtkText");
+    jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                            classAtkText,
+                                            "get_line_extents",
+                                            "(I)[I");
+    jintArray jextents = (*jniEnv)->CallObjectMethod(jniEnv, atk_text, jmid, (jint)offset);
+    if (jextents == NULL)
+      return NULL;
+
+    jsize length = (*jniEnv)->GetArrayLength(jniEnv, jextents);
+    if (length < 2)
+      return NULL;
+    jint bounds[2];
+    (*jniEnv)->GetIntArrayRegion(jniEnv, jextents, 0, 2, bounds);
+    if (bounds[1] <= bounds[0] || length != 2 + 4 * (bounds[1] - bounds[0]) ||
+        offset < bounds[0] || offset >= bounds[1])
+      return NULL;
+
+    line = g_new(JawTextLineExtents, 1);
+    line->start = bounds[0];
+    line->end = bounds[1];
+    line->serial = serial;
+    line->component_width = component_width;
+    line->component_height = component_height;
+    line->rects = g_new(gint, length - 2);
+    (*jniEnv)->GetIntArrayRegion(jniEnv, jextents, 2, length - 2, (jint*)line->rects);
+
+    i = JAW_TEXT_N_LINE_EXTENTS - 1;
+    if (data->line_extents[i] != NULL)
+    {
+      g_free(data->line_extents[i]->rects);
+      g_free(data->line_extents[i]);
+    }
+  }
+
+  /* Move it first */
+  memmove(&data->line_extents[1], &data->line_extents[0], i * sizeof(JawTextLineExtents*));
+  data->line_extents[0] = line;
+  return line;
+}
+
 static void
 jaw_text_get_character_extents (AtkText *text,
                                 gint offset, gint *x, gint *y,
@@ -379,6 +1163,29 @@ jaw_text_get_character_extents (AtkText *text,
   *height = -1;
   JAW_GET_TEXT(text, );
 
+  gint origin_x, origin_y, component_width, component_height;
+  if (!jaw_text_get_extents_origin(jniEnv, data, atk_text, coords, &origin_x, &origin_y,
+                                   &component_width, &component_height))
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return;
+  }
+
+  JawTextLineExtents *line = jaw_text_get_line_extents(jniEnv, data, atk_text, offset,
+                                                       component_width, component_height);
+  if (line != NULL)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    gint *r = line->rects + 4 * (offset - line->start);
+    if (r[2] < 0)
+      return;
+    *x = r[0] + origin_x;
+    *y = r[1] + origin_y;
+    *width = r[2];
+    *height = r[3];
+    return;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -407,6 +1214,22 @@ jaw_text_get_character_count (AtkText *text)
   JAW_DEBUG_C("%p", text);
   JAW_GET_TEXT(text, 0);
 
+  JawTextMirror *mirror = jaw_text_lock_mirror(jniEnv, data, atk_text);
+  if (mirror != NULL)
+  {
+    gint count = jaw_text_mirror_get_length(mirror);
+    g_mutex_unlock(&jaw_text_mirror_mutex);
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return count;
+  }
+
+  jint serial = jaw_text_get_serial(jniEnv, atk_text, "_text_serial");
+  if (data->count_valid && data->count_serial == serial)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return data->count;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -416,6 +1239,9 @@ jaw_text_get_character_count (AtkText *text)
   jint jcount = (*jniEnv)->CallIntMethod(jniEnv, atk_text, jmid);
   (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
 
+  data->count_serial = serial;
+  data->count = (gint)jcount;
+  data->count_valid = TRUE;
   return (gint)jcount;
 }
 
@@ -460,6 +1286,40 @@ jaw_text_get_range_extents (AtkText *text,
 
   JAW_GET_TEXT(text, );
 
+  /* Ranges within one line are the union of their characters */
+  gint origin_x, origin_y, component_width, component_height;
+  if (start_offset >= 0 && start_offset < end_offset &&
+      jaw_text_get_extents_origin(jniEnv, data, atk_text, coord_type, &origin_x, &origin_y,
+                                  &component_width, &component_height))
+  {
+    JawTextLineExtents *line = jaw_text_get_line_extents(jniEnv, data, atk_text, start_offset,
+                                                         component_width, component_height);
+    if (line != NULL && end_offset <= line->end)
+    {
+      (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+      gint x1 = G_MAXINT, y1 = G_MAXINT, x2 = G_MININT, y2 = G_MININT;
+      gint i;
+      for (i = start_offset; i < end_offset; i++)
+      {
+        gint *r = line->rects + 4 * (i - line->start);
+        if (r[2] < 0)
+          continue;
+        x1 = MIN(x1, r[0]);
+        y1 = MIN(y1, r[1]);
+        x2 = MAX(x2, r[0] + r[2]);
+        y2 = MAX(y2, r[1] + r[3]);
+      }
+      if (x1 <= x2)
+      {
+        rect->x = x1 + origin_x;
+        rect->y = y1 + origin_y;
+        rect->width = x2 - x1;
+        rect->height = y2 - y1;
+      }
+      return;
+    }
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -482,12 +1342,92 @@ jaw_text_get_range_extents (AtkText *text,
   jaw_util_get_rect_info(jniEnv, jrect, &(rect->x), &(rect->y), &(rect->width), &(rect->height));
 }
 
+static AtkTextRange**
+jaw_text_get_bounded_ranges (AtkText *text,
+                             AtkTextRectangle *rect,
+                             AtkCoordType coord_type,
+                             AtkTextClipType x_clip_type,
+                             AtkTextClipType y_clip_type)
+{
+  JAW_DEBUG_C("%p, %p, %d, %d, %d", text, rect, coord_type, x_clip_type, y_clip_type);
+  if (rect == NULL)
+  {
+    return NULL;
+  }
+  JAW_GET_TEXT(text, NULL);
+
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_bounded_ranges",
+                                          "(IIIIIII)[Lorg/GNOME/Accessibility/AtkText$TextRange;");
+  jobjectArray jranges = (*jniEnv)->CallObjectMethod(jniEnv,
+                                                     atk_text,
+                                                     jmid,
+                                                     (jint)rect->x,
+                                                     (jint)rect->y,
+                                                     (jint)rect->width,
+                                                     (jint)rect->height,
+                                                     (jint)coord_type,
+                                                     (jint)x_clip_type,
+                                                     (jint)y_clip_type);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+
+  if (jranges == NULL)
+  {
+    return NULL;
+  }
+
+  jclass classTextRange = (*jniEnv)->FindClass(jniEnv,
+                                               "org/GNOME/Accessibility/AtkText$TextRange");
+  jfieldID jfidStr = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "str", "Ljava/lang/String;");
+  jfieldID jfidStart = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "start_offset", "I");
+  jfieldID jfidEnd = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "end_offset", "I");
+  jfieldID jfidX = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "x", "I");
+  jfieldID jfidY = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "y", "I");
+  jfieldID jfidWidth = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "width", "I");
+  jfieldID jfidHeight = (*jniEnv)->GetFieldID(jniEnv, classTextRange, "height", "I");
+
+  jsize n = (*jniEnv)->GetArrayLength(jniEnv, jranges);
+  AtkTextRange **ranges = g_new0(AtkTextRange*, n + 1);
+  jsize i;
+  for (i = 0; i < n; i++)
+  {
+    jobject jrange = (*jniEnv)->GetObjectArrayElement(jniEnv, jranges, i);
+    jstring jstr = (*jniEnv)->GetObjectField(jniEnv, jrange, jfidStr);
+    AtkTextRange *range = g_new0(AtkTextRange, 1);
+    range->start_offset = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidStart);
+    range->end_offset = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidEnd);
+    range->bounds.x = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidX);
+    range->bounds.y = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidY);
+    range->bounds.width = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidWidth);
+    range->bounds.height = (gint)(*jniEnv)->GetIntField(jniEnv, jrange, jfidHeight);
+    range->content = jaw_text_get_gtext_from_jstr(jniEnv, jstr);
+    if (range->content == NULL)
+      range->content = g_strdup("");
+    ranges[i] = range;
+    if (jstr != NULL)
+      (*jniEnv)->DeleteLocalRef(jniEnv, jstr);
+    (*jniEnv)->DeleteLocalRef(jniEnv, jrange);
+  }
+
+  return ranges;
+}
+
 static gint
 jaw_text_get_n_selections (AtkText *text)
 {
   JAW_DEBUG_C("%p", text);
   JAW_GET_TEXT(text, 0);
 
+  jaw_text_check_caret(jniEnv, atk_text, data);
+  if (data->caret_flags & JAW_TEXT_N_SELECTIONS)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    return data->n_selections;
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
                                              "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
@@ -497,6 +1437,8 @@ jaw_text_get_n_selections (AtkText *text)
   jint jselections = (*jniEnv)->CallIntMethod(jniEnv, atk_text, jmid);
   (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
 
+  data->n_selections = (gint)jselections;
+  data->caret_flags |= JAW_TEXT_N_SELECTIONS;
   return (gint)jselections;
 }
 
@@ -506,6 +1448,17 @@ jaw_text_get_selection (AtkText *text, gint selection_num, gint *start_offset, g
   JAW_DEBUG_C("%p, %d, %p, %p", text, selection_num, start_offset, end_offset);
   JAW_GET_TEXT(text, NULL);
 
+  jaw_text_check_caret(jniEnv, atk_text, data);
+  if (data->caret_flags & JAW_TEXT_SELECTION)
+  {
+    (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+    if (data->selection == NULL)
+      return NULL;
+    *start_offset = data->selection_start;
+    *end_offset = data->selection_end;
+    return g_strdup(data->selection);
+  }
+
   jclass classAtkText = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkText");
   jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
                                           classAtkText,
@@ -516,6 +1469,7 @@ jaw_text_get_selection (AtkText *text, gint selection_num, gint *start_offset, g
 
   if (jStrSeq == NULL)
   {
+    data->caret_flags |= JAW_TEXT_SELECTION;
     return NULL;
   }
 
@@ -538,7 +1492,15 @@ jaw_text_get_selection (AtkText *text, gint selection_num, gint *start_offset, g
   *start_offset = (gint)(*jniEnv)->GetIntField(jniEnv, jStrSeq, jfidStart);
   *end_offset = (gint)(*jniEnv)->GetIntField(jniEnv, jStrSeq, jfidEnd);
 
-  return jaw_text_get_gtext_from_jstr(jniEnv, jStr);
+  gchar *str = jaw_text_get_gtext_from_jstr(jniEnv, jStr);
+  if (str != NULL)
+  {
+    data->selection = g_strdup(str);
+    data->selection_start = *start_offset;
+    data->selection_end = *end_offset;
+  }
+  data->caret_flags |= JAW_TEXT_SELECTION;
+  return str;
 }
 
 static gboolean
@@ -622,3 +1584,207 @@ jaw_text_set_caret_offset (AtkText *text, gint offset)
 
   return jresult;
 }
+
+/* Parse the "name:value" lines made by AtkTextAttributes */
+static AtkAttributeSet*
+jaw_text_attribute_set_from_string (const gchar *str)
+{
+  JAW_DEBUG_C("%s", str);
+  AtkAttributeSet *attributes = NULL;
+  gchar **lines = g_strsplit(str, "\n", -1);
+  gint i;
+
+  for (i = 0; lines[i] != NULL; i++)
+  {
+    gchar **pair = g_strsplit(lines[i], ":", 2);
+    if (pair[0] != NULL && pair[1] != NULL)
+    {
+      AtkAttribute *attribute = g_new(AtkAttribute, 1);
+      attribute->name = g_strdup(pair[0]);
+      attribute->value = g_strdup(pair[1]);
+      attributes = g_slist_prepend(attributes, attribute);
+    }
+    g_strfreev(pair);
+  }
+  g_strfreev(lines);
+
+  return g_slist_reverse(attributes);
+}
+
+static AtkAttributeSet*
+jaw_text_attribute_set_copy (AtkAttributeSet *attributes)
+{
+  AtkAttributeSet *copy = NULL;
+  GSList *cur;
+
+  for (cur = attributes; cur != NULL; cur = g_slist_next(cur))
+  {
+    AtkAttribute *attribute = (AtkAttribute*)cur->data;
+    AtkAttribute *attribute_copy = g_new(AtkAttribute, 1);
+    attribute_copy->name = g_strdup(attribute->name);
+    attribute_copy->value = g_strdup(attribute->value);
+    copy = g_slist_prepend(copy, attribute_copy);
+  }
+
+  return g_slist_reverse(copy);
+}
+
+/*
+ * Make sure data->runs is the run table of the current text, fetching it
+ * in one call when the text or its attributes changed since.  Equal
+ * attribute sets are only kept once, in data->run_sets.
+ */
+static gboolean
+jaw_text_update_runs (JNIEnv *jniEnv, TextData *data, jobject atk_text)
+{
+  JAW_DEBUG_C("%p, %p, %p", jniEnv, data, atk_text);
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jfieldID jfidSerial = (*jniEnv)->GetFieldID(jniEnv,
+                                              classAtkText,
+                                              "_attributes_serial",
+                                              "I");
+  jint serial = (*jniEnv)->GetIntField(jniEnv, atk_text, jfidSerial);
+  if (data->runs != NULL && data->runs_serial == serial)
+    return TRUE;
+
+  jaw_text_free_runs(data);
+
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_attribute_runs",
+                                          "()Lorg/GNOME/Accessibility/AtkTextAttributes$Runs;");
+  jobject jruns = (*jniEnv)->CallObjectMethod(jniEnv, atk_text, jmid);
+  if (jruns == NULL)
+  {
+    JAW_DEBUG_I("jruns == NULL");
+    return FALSE;
+  }
+
+  jclass classRuns = (*jniEnv)->FindClass(jniEnv,
+                                          "org/GNOME/Accessibility/AtkTextAttributes$Runs");
+  jfieldID jfidEnds = (*jniEnv)->GetFieldID(jniEnv, classRuns, "ends", "[I");
+  jfieldID jfidAttributes = (*jniEnv)->GetFieldID(jniEnv,
+                                                  classRuns,
+                                                  "attributes",
+                                                  "[Ljava/lang/String;");
+  jintArray jends = (*jniEnv)->GetObjectField(jniEnv, jruns, jfidEnds);
+  jobjectArray jattributes = (*jniEnv)->GetObjectField(jniEnv, jruns, jfidAttributes);
+  if (jends == NULL || jattributes == NULL)
+    return FALSE;
+
+  jsize n_runs = (*jniEnv)->GetArrayLength(jniEnv, jends);
+  if ((*jniEnv)->GetArrayLength(jniEnv, jattributes) != n_runs)
+    return FALSE;
+
+  jint *ends = (*jniEnv)->GetIntArrayElements(jniEnv, jends, NULL);
+  if (ends == NULL)
+    return FALSE;
+
+  data->runs = g_array_sized_new(FALSE, FALSE, sizeof(JawTextRun), n_runs);
+  data->run_sets = g_hash_table_new_full(g_str_hash,
+                                         g_str_equal,
+                                         g_free,
+                                         (GDestroyNotify)atk_attribute_set_free);
+  GString *key_buf = g_string_new(NULL);
+  jsize i;
+  for (i = 0; i < n_runs; i++)
+  {
+    JawTextRun run;
+    gpointer key, value;
+    jstring jstr = (*jniEnv)->GetObjectArrayElement(jniEnv, jattributes, i);
+
+    g_string_truncate(key_buf, 0);
+    jaw_util_append_string_utf8(jniEnv, jstr, key_buf);
+    if (g_hash_table_lookup_extended(data->run_sets, key_buf->str, &key, &value))
+    {
+      run.attributes = (AtkAttributeSet*)value;
+    }
+    else
+    {
+      run.attributes = jaw_text_attribute_set_from_string(key_buf->str);
+      g_hash_table_insert(data->run_sets, g_strdup(key_buf->str), run.attributes);
+    }
+    run.end = (gint)ends[i];
+    g_array_append_val(data->runs, run);
+
+    if (jstr != NULL)
+      (*jniEnv)->DeleteLocalRef(jniEnv, jstr);
+  }
+  g_string_free(key_buf, TRUE);
+  (*jniEnv)->ReleaseIntArrayElements(jniEnv, jends, ends, JNI_ABORT);
+
+  data->runs_serial = serial;
+  return TRUE;
+}
+
+static AtkAttributeSet*
+jaw_text_get_run_attributes (AtkText *text,
+                             gint offset,
+                             gint *start_offset,
+                             gint *end_offset)
+{
+  JAW_DEBUG_C("%p, %d, %p, %p", text, offset, start_offset, end_offset);
+  JAW_GET_TEXT(text, NULL);
+
+  gboolean updated = jaw_text_update_runs(jniEnv, data, atk_text);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+  if (!updated)
+    return NULL;
+
+  GArray *runs = data->runs;
+  gint count = 0;
+  if (runs->len > 0)
+    count = g_array_index(runs, JawTextRun, runs->len - 1).end;
+
+  if (offset < 0 || offset >= count)
+  {
+    *start_offset = *end_offset = CLAMP(offset, 0, count);
+    return NULL;
+  }
+
+  /* First run ending after offset */
+  guint low = 0;
+  guint high = runs->len - 1;
+  while (low < high)
+  {
+    guint mid = (low + high) / 2;
+    if (g_array_index(runs, JawTextRun, mid).end <= offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  JawTextRun *run = &g_array_index(runs, JawTextRun, low);
+  *start_offset = (low > 0) ? g_array_index(runs, JawTextRun, low - 1).end : 0;
+  *end_offset = run->end;
+
+  return jaw_text_attribute_set_copy(run->attributes);
+}
+
+static AtkAttributeSet*
+jaw_text_get_default_attributes (AtkText *text)
+{
+  JAW_DEBUG_C("%p", text);
+  JAW_GET_TEXT(text, NULL);
+
+  jclass classAtkText = (*jniEnv)->FindClass(jniEnv,
+                                             "org/GNOME/Accessibility/AtkText");
+  jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv,
+                                          classAtkText,
+                                          "get_default_attributes",
+                                          "()Ljava/lang/String;");
+  jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_text, jmid);
+  (*jniEnv)->DeleteGlobalRef(jniEnv, atk_text);
+
+  if (jstr == NULL)
+  {
+    return NULL;
+  }
+
+  gchar *str = jaw_util_get_string_utf8(jniEnv, jstr);
+  AtkAttributeSet *attributes = jaw_text_attribute_set_from_string(str);
+  g_free(str);
+
+  return attributes;
+}
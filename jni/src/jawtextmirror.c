@@ -0,0 +1,360 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <glib.h>
+#include "jawutil.h"
+#include "jawtextmirror.h"
+
+#define JAW_TEXT_MIRROR_CHUNK 1024
+
+typedef struct _JawTextChunk {
+  gint len;
+  gunichar2 units[JAW_TEXT_MIRROR_CHUNK];
+} JawTextChunk;
+
+struct _JawTextMirror {
+  /* Never empty, and only the last chunk may have len == 0 */
+  GPtrArray *chunks;
+  /* Offset of the first unit of each chunk, up to n_starts */
+  GArray *starts;
+  guint n_starts;
+  gint length;
+  /* Number of surrogate units, offsets are characters when there is none */
+  gint n_surrogates;
+  gboolean valid;
+  /* Number of edits seen, whether they could be applied or not */
+  guint serial;
+};
+
+#define JAW_TEXT_MIRROR_GET_CHUNK(mirror, i) \
+  ((JawTextChunk*)g_ptr_array_index((mirror)->chunks, (i)))
+
+static gint
+jaw_text_mirror_count_surrogates (const gunichar2 *units, gint n_units)
+{
+  gint n = 0;
+  gint i;
+
+  for (i = 0; i < n_units; i++)
+  {
+    if ((units[i] & 0xf800) == 0xd800)
+      n++;
+  }
+  return n;
+}
+
+JawTextMirror*
+jaw_text_mirror_new (void)
+{
+  JAW_DEBUG_C("");
+  JawTextMirror *mirror = g_new0(JawTextMirror, 1);
+  mirror->chunks = g_ptr_array_new_with_free_func(g_free);
+  g_ptr_array_add(mirror->chunks, g_new0(JawTextChunk, 1));
+  mirror->starts = g_array_new(FALSE, TRUE, sizeof(gint));
+  mirror->n_starts = 0;
+  mirror->length = 0;
+  mirror->n_surrogates = 0;
+  mirror->valid = FALSE;
+  mirror->serial = 0;
+
+  return mirror;
+}
+
+void
+jaw_text_mirror_free (JawTextMirror *mirror)
+{
+  JAW_DEBUG_C("%p", mirror);
+  if (mirror == NULL)
+    return;
+
+  g_ptr_array_free(mirror->chunks, TRUE);
+  g_array_free(mirror->starts, TRUE);
+  g_free(mirror);
+}
+
+gboolean
+jaw_text_mirror_is_valid (JawTextMirror *mirror)
+{
+  return mirror != NULL && mirror->valid;
+}
+
+static void
+jaw_text_mirror_clear (JawTextMirror *mirror)
+{
+  g_ptr_array_set_size(mirror->chunks, 0);
+  g_ptr_array_add(mirror->chunks, g_new0(JawTextChunk, 1));
+  mirror->n_starts = 0;
+  mirror->length = 0;
+  mirror->n_surrogates = 0;
+}
+
+guint
+jaw_text_mirror_get_serial (JawTextMirror *mirror)
+{
+  return mirror->serial;
+}
+
+void
+jaw_text_mirror_invalidate (JawTextMirror *mirror)
+{
+  JAW_DEBUG_C("%p", mirror);
+  mirror->serial++;
+  if (!mirror->valid)
+    return;
+
+  jaw_text_mirror_clear(mirror);
+  mirror->valid = FALSE;
+}
+
+static void
+jaw_text_mirror_update_starts (JawTextMirror *mirror)
+{
+  guint n_chunks = mirror->chunks->len;
+  guint i = mirror->n_starts;
+  gint start = 0;
+
+  if (i >= n_chunks)
+    return;
+
+  g_array_set_size(mirror->starts, n_chunks);
+  if (i > 0)
+    start = g_array_index(mirror->starts, gint, i - 1) + JAW_TEXT_MIRROR_GET_CHUNK(mirror, i - 1)->len;
+
+  for (; i < n_chunks; i++)
+  {
+    g_array_index(mirror->starts, gint, i) = start;
+    start += JAW_TEXT_MIRROR_GET_CHUNK(mirror, i)->len;
+  }
+  mirror->n_starts = n_chunks;
+}
+
+/* Last chunk starting at or before offset, with the offset inside it */
+static guint
+jaw_text_mirror_find_chunk (JawTextMirror *mirror, gint offset, gint *chunk_offset)
+{
+  jaw_text_mirror_update_starts(mirror);
+
+  guint low = 0;
+  guint high = mirror->chunks->len - 1;
+  while (low < high)
+  {
+    guint mid = (low + high + 1) / 2;
+    if (g_array_index(mirror->starts, gint, mid) <= offset)
+      low = mid;
+    else
+      high = mid - 1;
+  }
+
+  *chunk_offset = offset - g_array_index(mirror->starts, gint, low);
+  return low;
+}
+
+/* Append units to the chunk at *index, adding chunks after it as they fill up */
+static void
+jaw_text_mirror_append_units (JawTextMirror *mirror,
+                              guint *index,
+                              const gunichar2 *units,
+                              gint n_units)
+{
+  JawTextChunk *chunk = JAW_TEXT_MIRROR_GET_CHUNK(mirror, *index);
+
+  while (n_units > 0)
+  {
+    if (chunk->len == JAW_TEXT_MIRROR_CHUNK)
+    {
+      chunk = g_new0(JawTextChunk, 1);
+      g_ptr_array_insert(mirror->chunks, ++(*index), chunk);
+    }
+
+    gint n = MIN(n_units, JAW_TEXT_MIRROR_CHUNK - chunk->len);
+    memcpy(chunk->units + chunk->len, units, n * sizeof(gunichar2));
+    chunk->len += n;
+    units += n;
+    n_units -= n;
+  }
+}
+
+void
+jaw_text_mirror_set (JawTextMirror *mirror, const gunichar2 *units, gint n_units)
+{
+  JAW_DEBUG_C("%p, %p, %d", mirror, units, n_units);
+  guint index = 0;
+
+  jaw_text_mirror_clear(mirror);
+  jaw_text_mirror_append_units(mirror, &index, units, n_units);
+  mirror->length = n_units;
+  mirror->n_surrogates = jaw_text_mirror_count_surrogates(units, n_units);
+  mirror->valid = TRUE;
+}
+
+gboolean
+jaw_text_mirror_insert (JawTextMirror *mirror,
+                        gint offset,
+                        const gunichar2 *units,
+                        gint n_units)
+{
+  JAW_DEBUG_C("%p, %d, %p, %d", mirror, offset, units, n_units);
+  mirror->serial++;
+  if (!mirror->valid || offset < 0 || offset > mirror->length || n_units < 0)
+    return FALSE;
+  if (n_units == 0)
+    return TRUE;
+
+  gint chunk_offset;
+  guint index = jaw_text_mirror_find_chunk(mirror, offset, &chunk_offset);
+  JawTextChunk *chunk = JAW_TEXT_MIRROR_GET_CHUNK(mirror, index);
+
+  if (chunk->len + n_units <= JAW_TEXT_MIRROR_CHUNK)
+  {
+    memmove(chunk->units + chunk_offset + n_units,
+            chunk->units + chunk_offset,
+            (chunk->len - chunk_offset) * sizeof(gunichar2));
+    memcpy(chunk->units + chunk_offset, units, n_units * sizeof(gunichar2));
+    chunk->len += n_units;
+  }
+  else
+  {
+    /* Split the chunk, the tail goes into a chunk of its own so that
+     * further typing at the same place has room again */
+    gint tail_len = chunk->len - chunk_offset;
+    gunichar2 *tail = g_new(gunichar2, MAX(tail_len, 1));
+    memcpy(tail, chunk->units + chunk_offset, tail_len * sizeof(gunichar2));
+    chunk->len = chunk_offset;
+
+    guint last = index;
+    jaw_text_mirror_append_units(mirror, &last, units, n_units);
+    if (tail_len > 0)
+    {
+      g_ptr_array_insert(mirror->chunks, ++last, g_new0(JawTextChunk, 1));
+      jaw_text_mirror_append_units(mirror, &last, tail, tail_len);
+    }
+    g_free(tail);
+  }
+
+  mirror->n_starts = MIN(mirror->n_starts, index + 1);
+  mirror->length += n_units;
+  mirror->n_surrogates += jaw_text_mirror_count_surrogates(units, n_units);
+  return TRUE;
+}
+
+gboolean
+jaw_text_mirror_delete (JawTextMirror *mirror, gint offset, gint n_units)
+{
+  JAW_DEBUG_C("%p, %d, %d", mirror, offset, n_units);
+  mirror->serial++;
+  if (!mirror->valid || offset < 0 || n_units < 0 || offset + n_units > mirror->length)
+    return FALSE;
+
+  while (n_units > 0)
+  {
+    gint chunk_offset;
+    guint index = jaw_text_mirror_find_chunk(mirror, offset, &chunk_offset);
+    JawTextChunk *chunk = JAW_TEXT_MIRROR_GET_CHUNK(mirror, index);
+    gint n = MIN(n_units, chunk->len - chunk_offset);
+
+    mirror->n_surrogates -= jaw_text_mirror_count_surrogates(chunk->units + chunk_offset, n);
+    memmove(chunk->units + chunk_offset,
+            chunk->units + chunk_offset + n,
+            (chunk->len - chunk_offset - n) * sizeof(gunichar2));
+    chunk->len -= n;
+    n_units -= n;
+    mirror->length -= n;
+    mirror->n_starts = MIN(mirror->n_starts, index + 1);
+
+    if (chunk->len == 0 && mirror->chunks->len > 1)
+    {
+      g_ptr_array_remove_index(mirror->chunks, index);
+      mirror->n_starts = MIN(mirror->n_starts, index);
+    }
+  }
+
+  return TRUE;
+}
+
+gint
+jaw_text_mirror_get_length (JawTextMirror *mirror)
+{
+  return mirror->length;
+}
+
+gboolean
+jaw_text_mirror_has_surrogates (JawTextMirror *mirror)
+{
+  return mirror->n_surrogates > 0;
+}
+
+gunichar2
+jaw_text_mirror_get_char (JawTextMirror *mirror, gint offset)
+{
+  JAW_DEBUG_C("%p, %d", mirror, offset);
+  if (offset < 0 || offset >= mirror->length)
+    return 0;
+
+  gint chunk_offset;
+  guint index = jaw_text_mirror_find_chunk(mirror, offset, &chunk_offset);
+  return JAW_TEXT_MIRROR_GET_CHUNK(mirror, index)->units[chunk_offset];
+}
+
+/* UTF-8 copy of [start, end), or NULL if it is not valid UTF-16 */
+gchar*
+jaw_text_mirror_get_text (JawTextMirror *mirror, gint start, gint end)
+{
+  JAW_DEBUG_C("%p, %d, %d", mirror, start, end);
+  start = CLAMP(start, 0, mirror->length);
+  end = CLAMP(end, start, mirror->length);
+  if (start == end)
+    return g_strdup("");
+
+  gunichar2 *units = g_new(gunichar2, end - start);
+  gint n = 0;
+  gint chunk_offset;
+  guint index = jaw_text_mirror_find_chunk(mirror, start, &chunk_offset);
+
+  while (n < end - start)
+  {
+    JawTextChunk *chunk = JAW_TEXT_MIRROR_GET_CHUNK(mirror, index++);
+    gint k = MIN(chunk->len - chunk_offset, end - start - n);
+    memcpy(units + n, chunk->units + chunk_offset, k * sizeof(gunichar2));
+    n += k;
+    chunk_offset = 0;
+  }
+
+  gchar *text = g_utf16_to_utf8(units, n, NULL, NULL, NULL);
+  g_free(units);
+  return text;
+}
+
+/* Same value as java.lang.String.hashCode() on the whole text */
+gint32
+jaw_text_mirror_get_hash (JawTextMirror *mirror)
+{
+  JAW_DEBUG_C("%p", mirror);
+  guint32 hash = 0;
+  guint i;
+
+  for (i = 0; i < mirror->chunks->len; i++)
+  {
+    JawTextChunk *chunk = JAW_TEXT_MIRROR_GET_CHUNK(mirror, i);
+    gint j;
+    for (j = 0; j < chunk->len; j++)
+      hash = 31 * hash + chunk->units[j];
+  }
+
+  return (gint32)hash;
+}
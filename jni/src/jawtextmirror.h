@@ -0,0 +1,51 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_TEXT_MIRROR_H_
+#define _JAW_TEXT_MIRROR_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A native copy of the UTF-16 text of a Java text object, stored as a
+ * list of bounded chunks so that edits only move the data of one chunk.
+ * It knows nothing about locking: jawtext.c does that.
+ */
+typedef struct _JawTextMirror		JawTextMirror;
+
+JawTextMirror* jaw_text_mirror_new(void);
+void jaw_text_mirror_free(JawTextMirror*);
+
+gboolean jaw_text_mirror_is_valid(JawTextMirror*);
+guint jaw_text_mirror_get_serial(JawTextMirror*);
+void jaw_text_mirror_invalidate(JawTextMirror*);
+void jaw_text_mirror_set(JawTextMirror*, const gunichar2*, gint);
+gboolean jaw_text_mirror_insert(JawTextMirror*, gint, const gunichar2*, gint);
+gboolean jaw_text_mirror_delete(JawTextMirror*, gint, gint);
+
+gint jaw_text_mirror_get_length(JawTextMirror*);
+gboolean jaw_text_mirror_has_surrogates(JawTextMirror*);
+gunichar2 jaw_text_mirror_get_char(JawTextMirror*, gint);
+gchar* jaw_text_mirror_get_text(JawTextMirror*, gint, gint);
+gint32 jaw_text_mirror_get_hash(JawTextMirror*);
+
+G_END_DECLS
+
+#endif
@@ -679,11 +679,22 @@ jaw_util_get_rect_info (JNIEnv *jniEnv,
                         gint *height)
 {
   JAW_DEBUG_C("%p, %p, %p, %p, %p, %p", jniEnv, jrect, x, y, width, height);
-  jclass classRectangle = (*jniEnv)->FindClass(jniEnv, "java/awt/Rectangle");
-  jfieldID jfidX = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "x", "I");
-  jfieldID jfidY = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "y", "I");
-  jfieldID jfidWidth = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "width", "I");
-  jfieldID jfidHeight = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "height", "I");
+  /*
+   * java.awt.Rectangle comes from the boot class loader, so it is never
+   * unloaded and its field IDs can be looked up once for all.
+   */
+  static jfieldID jfidX, jfidY, jfidWidth, jfidHeight;
+  static gsize ids_ready = 0;
+  if (g_once_init_enter(&ids_ready))
+  {
+    jclass classRectangle = (*jniEnv)->FindClass(jniEnv, "java/awt/Rectangle");
+    jfidX = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "x", "I");
+    jfidY = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "y", "I");
+    jfidWidth = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "width", "I");
+    jfidHeight = (*jniEnv)->GetFieldID(jniEnv, classRectangle, "height", "I");
+    (*jniEnv)->DeleteLocalRef(jniEnv, classRectangle);
+    g_once_init_leave(&ids_ready, 1);
+  }
 
   (*x) = (gint)(*jniEnv)->GetIntField(jniEnv, jrect, jfidX);
   (*y) = (gint)(*jniEnv)->GetIntField(jniEnv, jrect, jfidY);
@@ -691,6 +702,183 @@ jaw_util_get_rect_info (JNIEnv *jniEnv,
   (*height) = (gint)(*jniEnv)->GetIntField(jniEnv, jrect, jfidHeight);
 }
 
+/*
+ * Convert UTF-16 to standard UTF-8 into buf, which must have room for
+ * JAW_UTIL_UTF8_MAX_LEN(n_units) bytes.  Surrogate pairs become four byte
+ * sequences, and unpaired surrogates U+FFFD.  Returns the length written,
+ * not counting the terminating NUL.
+ */
+gsize
+jaw_util_utf16_to_utf8 (const jchar *units, gsize n_units, gchar *buf)
+{
+  gchar *out = buf;
+  gsize i = 0;
+
+  while (i < n_units)
+  {
+    /* Runs of ASCII, four code units at a time */
+    while (i + 4 <= n_units)
+    {
+      guint64 block;
+      memcpy(&block, units + i, sizeof(block));
+      if (block & G_GUINT64_CONSTANT(0xff80ff80ff80ff80))
+        break;
+      out[0] = (gchar)units[i];
+      out[1] = (gchar)units[i + 1];
+      out[2] = (gchar)units[i + 2];
+      out[3] = (gchar)units[i + 3];
+      out += 4;
+      i += 4;
+    }
+    if (i >= n_units)
+      break;
+
+    gunichar c = units[i++];
+    if (c < 0x80)
+    {
+      *out++ = (gchar)c;
+    }
+    else if (c < 0x800)
+    {
+      *out++ = (gchar)(0xc0 | (c >> 6));
+      *out++ = (gchar)(0x80 | (c & 0x3f));
+    }
+    else if (c >= 0xd800 && c < 0xdc00 &&
+             i < n_units && units[i] >= 0xdc00 && units[i] < 0xe000)
+    {
+      c = 0x10000 + ((c - 0xd800) << 10) + (units[i++] - 0xdc00);
+      *out++ = (gchar)(0xf0 | (c >> 18));
+      *out++ = (gchar)(0x80 | ((c >> 12) & 0x3f));
+      *out++ = (gchar)(0x80 | ((c >> 6) & 0x3f));
+      *out++ = (gchar)(0x80 | (c & 0x3f));
+    }
+    else
+    {
+      if (c >= 0xd800 && c < 0xe000)
+        c = 0xfffd;
+      *out++ = (gchar)(0xe0 | (c >> 12));
+      *out++ = (gchar)(0x80 | ((c >> 6) & 0x3f));
+      *out++ = (gchar)(0x80 | (c & 0x3f));
+    }
+  }
+
+  *out = '\0';
+  return out - buf;
+}
+
+/* Strings up to this many code units are copied out instead of pinned */
+#define JAW_UTIL_STRING_REGION_MAX 256
+
+/*
+ * Append the UTF-8 form of jstr to buf, returning the number of bytes
+ * added.  Short strings are copied with GetStringRegion, long ones are
+ * read in place with GetStringCritical, so the text is only copied once
+ * on its way into buf.
+ */
+gsize
+jaw_util_append_string_utf8 (JNIEnv *jniEnv, jstring jstr, GString *buf)
+{
+  JAW_DEBUG_C("%p, %p, %p", jniEnv, jstr, buf);
+  if (jstr == NULL)
+    return 0;
+
+  jsize n_units = (*jniEnv)->GetStringLength(jniEnv, jstr);
+  gsize old_len = buf->len;
+  gsize len;
+
+  /* Make room first: nothing may allocate while the string is pinned */
+  g_string_set_size(buf, old_len + JAW_UTIL_UTF8_MAX_LEN(n_units));
+
+  if (n_units <= JAW_UTIL_STRING_REGION_MAX)
+  {
+    jchar units[JAW_UTIL_STRING_REGION_MAX];
+    (*jniEnv)->GetStringRegion(jniEnv, jstr, 0, n_units, units);
+    len = jaw_util_utf16_to_utf8(units, n_units, buf->str + old_len);
+  }
+  else
+  {
+    const jchar *units = (*jniEnv)->GetStringCritical(jniEnv, jstr, NULL);
+    if (units == NULL)
+    {
+      g_string_truncate(buf, old_len);
+      return 0;
+    }
+    len = jaw_util_utf16_to_utf8(units, n_units, buf->str + old_len);
+    (*jniEnv)->ReleaseStringCritical(jniEnv, jstr, units);
+  }
+
+  g_string_truncate(buf, old_len + len);
+  return len;
+}
+
+/* Newly allocated UTF-8 copy of jstr, NULL if jstr is NULL */
+gchar*
+jaw_util_get_string_utf8 (JNIEnv *jniEnv, jstring jstr)
+{
+  JAW_DEBUG_C("%p, %p", jniEnv, jstr);
+  if (jstr == NULL)
+    return NULL;
+
+  jsize n_units = (*jniEnv)->GetStringLength(jniEnv, jstr);
+  GString *buf = g_string_sized_new(JAW_UTIL_UTF8_MAX_LEN(n_units));
+  jaw_util_append_string_utf8(jniEnv, jstr, buf);
+
+  /* Don't keep the room reserved for non-ASCII text if it wasn't needed */
+  gsize len = buf->len;
+  gchar *str = g_string_free(buf, FALSE);
+  return g_realloc(str, len + 1);
+}
+
+static gint
+jaw_util_compare_ints (gconstpointer a, gconstpointer b)
+{
+  gint x = *(const gint*)a;
+  gint y = *(const gint*)b;
+  return (x > y) - (x < y);
+}
+
+/* Newly allocated sorted copy of jarr, with its length in *n, NULL if empty */
+gint*
+jaw_util_get_sorted_ints (JNIEnv *jniEnv, jintArray jarr, gint *n)
+{
+  JAW_DEBUG_C("%p, %p, %p", jniEnv, jarr, n);
+  *n = 0;
+  if (jarr == NULL)
+    return NULL;
+
+  jsize length = (*jniEnv)->GetArrayLength(jniEnv, jarr);
+  if (length == 0)
+    return NULL;
+
+  gint *ints = g_new(gint, length);
+  jint *jints = (*jniEnv)->GetIntArrayElements(jniEnv, jarr, NULL);
+  jsize i;
+  for (i = 0; i < length; i++)
+    ints[i] = (gint)jints[i];
+  (*jniEnv)->ReleaseIntArrayElements(jniEnv, jarr, jints, JNI_ABORT);
+
+  qsort(ints, length, sizeof(gint), jaw_util_compare_ints);
+  *n = length;
+  return ints;
+}
+
+/* Binary search of value in the n sorted ints */
+gboolean
+jaw_util_sorted_ints_contain (const gint *ints, gint n, gint value)
+{
+  gint low = 0;
+  gint high = n;
+  while (low < high)
+  {
+    gint mid = low + (high - low) / 2;
+    if (ints[mid] < value)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low < n && ints[low] == value;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,6 +114,15 @@ void jaw_util_get_rect_info(JNIEnv *jniEnv,
                             gint *height);
 gboolean jaw_util_dispatch_key_event (AtkKeyEventStruct *event);
 
+/* Longest UTF-8 encoding of n_units UTF-16 code units, with the NUL */
+#define JAW_UTIL_UTF8_MAX_LEN(n_units) ((gsize)(n_units) * 3 + 1)
+
+gsize jaw_util_utf16_to_utf8(const jchar *units, gsize n_units, gchar *buf);
+gsize jaw_util_append_string_utf8(JNIEnv *jniEnv, jstring jstr, GString *buf);
+gchar* jaw_util_get_string_utf8(JNIEnv *jniEnv, jstring jstr);
+gint* jaw_util_get_sorted_ints(JNIEnv *jniEnv, jintArray jarr, gint *n);
+gboolean jaw_util_sorted_ints_contain(const gint *ints, gint n, gint value);
+
 guint jni_main_idle_add(GSourceFunc function, gpointer data);
 
 void jaw_util_detach(void);
@@ -126,6 +135,7 @@ void jaw_util_detach(void);
   } \
   Data *data = jaw_object_get_interface_data(jaw_obj, iface); \
   JNIEnv *env = jaw_util_get_jni_env(); \
+  jaw_object_listen(jaw_obj, env); \
   jobject name = (*env)->NewGlobalRef(env, data->field); \
   if (!name) { \
     JAW_DEBUG_I(#name " == NULL"); \
@@ -21,9 +21,12 @@
 package org.GNOME.Accessibility;
 
 import javax.accessibility.*;
+import java.awt.Component;
+import java.awt.Dimension;
 import java.awt.Point;
 import java.awt.Rectangle;
 import java.lang.ref.WeakReference;
+import java.util.Arrays;
 
 public class AtkComponent {
 
@@ -40,17 +43,13 @@ public class AtkComponent {
       return AtkUtil.invokeInSwing ( () -> { return new AtkComponent(ac); }, null);
   }
 
-  static public Point getWindowLocation(AccessibleContext ac) {
+  static AccessibleContext getWindowContext(AccessibleContext ac) {
       while (ac != null) {
           AccessibleRole role = ac.getAccessibleRole();
           if (role == AccessibleRole.DIALOG ||
               role == AccessibleRole.FRAME ||
-              role == AccessibleRole.WINDOW) {
-              AccessibleComponent acc_comp = ac.getAccessibleComponent();
-              if (acc_comp == null)
-                  return null;
-              return acc_comp.getLocationOnScreen();
-          }
+              role == AccessibleRole.WINDOW)
+              return ac;
           Accessible parent = ac.getAccessibleParent();
           if (parent == null)
               return null;
@@ -59,6 +58,16 @@ public class AtkComponent {
       return null;
   }
 
+  static public Point getWindowLocation(AccessibleContext ac) {
+      ac = getWindowContext(ac);
+      if (ac == null)
+          return null;
+      AccessibleComponent acc_comp = ac.getAccessibleComponent();
+      if (acc_comp == null)
+          return null;
+      return acc_comp.getLocationOnScreen();
+  }
+
   // Return the position of the object relative to the coordinate type
   public static Point getComponentOrigin(AccessibleContext ac, AccessibleComponent acc_component, int coord_type) {
       if (coord_type == AtkCoordType.SCREEN)
@@ -157,6 +166,147 @@ public class AtkComponent {
       }, null);
   }
 
+  /*
+   * JawImpl of the window the component is in, 0 if none, which
+   * jawcomponent.c keeps to convert WINDOW coordinates by itself.
+   */
+  public long get_window_instance () {
+      AccessibleContext ac = _ac.get();
+      if (ac == null)
+          return 0;
+
+      return AtkUtil.invokeInSwing ( () -> {
+          AccessibleContext window_ac = getWindowContext(ac);
+          if (window_ac == null)
+              return 0l;
+          return AtkWrapper.getInstance(window_ac);
+      }, 0l);
+  }
+
+  public Point get_location_on_screen () {
+      AccessibleComponent acc_component = _acc_component.get();
+      if (acc_component == null)
+          return null;
+
+      return AtkUtil.invokeInSwing ( () -> {
+          if (!acc_component.isShowing())
+              return null;
+          return acc_component.getLocationOnScreen();
+      }, null);
+  }
+
+  /*
+   * Where the children of the component are, for jawcomponent.c to find the
+   * one at a point or their extents by itself: instance is the JawImpl of
+   * the component, origins holds x, y of the component for each
+   * AtkCoordType, and bounds x, y, width, height within the component of
+   * each showing child, in the order getAccessibleAt() tries them.
+   */
+  public static class ChildrenLayout {
+      public long instance;
+      public int[] origins;
+      public int width;
+      public int height;
+      public long[] instances;
+      public int[] bounds;
+  }
+
+  // Only called from the Swing thread
+  static ChildrenLayout getChildrenLayout(AccessibleContext ac, AccessibleComponent acc_component) {
+      if (!acc_component.isVisible() || !acc_component.isShowing())
+          return null;
+      if (AtkObject.hasTransientChildren(ac))
+          return null;
+
+      ChildrenLayout layout = new ChildrenLayout();
+      layout.instance = AtkWrapper.getInstance(ac);
+      layout.origins = new int[6];
+      int[] coord_types = { AtkCoordType.SCREEN, AtkCoordType.WINDOW, AtkCoordType.PARENT };
+      for (int coord_type : coord_types) {
+          Point p = getComponentOrigin(ac, acc_component, coord_type);
+          if (p == null)
+              return null;
+          layout.origins[2 * coord_type] = p.x;
+          layout.origins[2 * coord_type + 1] = p.y;
+      }
+      Dimension size = acc_component.getSize();
+      if (size == null)
+          return null;
+      layout.width = size.width;
+      layout.height = size.height;
+
+      int n_children = ac.getAccessibleChildrenCount();
+      long[] instances = new long[n_children];
+      int[] bounds = new int[4 * n_children];
+      int n = 0;
+      for (int i = 0; i < n_children; i++) {
+          Accessible child = ac.getAccessibleChild(i);
+          if (child == null)
+              continue;
+          AccessibleContext child_ac = child.getAccessibleContext();
+          if (child_ac == null)
+              continue;
+          AccessibleComponent child_component = child_ac.getAccessibleComponent();
+          if (child_component == null || !child_component.isShowing())
+              continue;
+          // Children which are not Components, such as the pages of a
+          // JTabbedPane, move without any event, so they can't be kept
+          if (!(child instanceof Component))
+              return null;
+          Rectangle rect = child_component.getBounds();
+          if (rect == null)
+              continue;
+          long instance = AtkWrapper.getInstance(child_ac);
+          if (instance == 0)
+              continue;
+          instances[n] = instance;
+          bounds[4 * n] = rect.x;
+          bounds[4 * n + 1] = rect.y;
+          bounds[4 * n + 2] = rect.width;
+          bounds[4 * n + 3] = rect.height;
+          n++;
+      }
+      layout.instances = Arrays.copyOf(instances, n);
+      layout.bounds = Arrays.copyOf(bounds, 4 * n);
+      return layout;
+  }
+
+  public ChildrenLayout get_children_layout () {
+      AccessibleContext ac = _ac.get();
+      if (ac == null)
+          return null;
+      AccessibleComponent acc_component = _acc_component.get();
+      if (acc_component == null)
+          return null;
+
+      return AtkUtil.invokeInSwing ( () -> {
+          return getChildrenLayout(ac, acc_component);
+      }, null);
+  }
+
+  /*
+   * The layout of the parent, which holds the extents of the component and
+   * of all its siblings, for ATs asking each of them in turn.
+   */
+  public ChildrenLayout get_parent_layout () {
+      AccessibleContext ac = _ac.get();
+      if (ac == null)
+          return null;
+
+      return AtkUtil.invokeInSwing ( () -> {
+          Accessible parent = ac.getAccessibleParent();
+          if (parent == null)
+              return null;
+          AccessibleContext parent_ac = parent.getAccessibleContext();
+          if (parent_ac == null)
+              return null;
+          AccessibleComponent parent_component = parent_ac.getAccessibleComponent();
+          if (parent_component == null)
+              return null;
+          return getChildrenLayout(parent_ac, parent_component);
+      }, null);
+  }
+
     public boolean grab_focus () {
         AccessibleComponent acc_component = _acc_component.get();
         if (acc_component == null)
@@ -56,7 +56,7 @@ public class AtkEditableText extends AtkText {
         if (position < 0)
             position = 0;
         final int rightPosition = position;
-        AtkUtil.invokeInSwing( () -> { acc_edt_text.insertTextAtIndex(rightPosition, s); });
+        AtkUtil.invokeInSwing( () -> { acc_edt_text.insertTextAtIndex(toUnits(rightPosition), s); });
     }
 
     public void copy_text (int start, int end) {
@@ -64,7 +64,7 @@ public class AtkEditableText extends AtkText {
         if (acc_edt_text == null)
             return;
 
-        int n = acc_edt_text.getCharCount();
+        int n = get_character_count();
         if (start < 0) {
             start = 0;
         }
@@ -76,7 +76,7 @@ public class AtkEditableText extends AtkText {
         final int rightStart = start;
         final int rightEnd = end;
         AtkUtil.invokeInSwing ( () -> {
-            String s = acc_edt_text.getTextRange(rightStart, rightEnd);
+            String s = acc_edt_text.getTextRange(toUnits(rightStart), toUnits(rightEnd));
             if (s != null) {
                 StringSelection stringSel = new StringSelection(s);
                 Toolkit.getDefaultToolkit().getSystemClipboard().setContents(stringSel, stringSel);
@@ -89,7 +89,7 @@ public class AtkEditableText extends AtkText {
         if (acc_edt_text == null)
             return;
 
-        AtkUtil.invokeInSwing( () -> { acc_edt_text.cut(start, end); });
+        AtkUtil.invokeInSwing( () -> { acc_edt_text.cut(toUnits(start), toUnits(end)); });
     }
 
     public void delete_text (int start, int end) {
@@ -97,7 +97,7 @@ public class AtkEditableText extends AtkText {
         if (acc_edt_text == null)
             return;
 
-        AtkUtil.invokeInSwing( () -> { acc_edt_text.delete(start, end); });
+        AtkUtil.invokeInSwing( () -> { acc_edt_text.delete(toUnits(start), toUnits(end)); });
     }
 
     public void paste_text (int position) {
@@ -105,7 +105,7 @@ public class AtkEditableText extends AtkText {
         if (acc_edt_text == null)
             return;
 
-        AtkUtil.invokeInSwing( () -> { acc_edt_text.paste(position); });
+        AtkUtil.invokeInSwing( () -> { acc_edt_text.paste(toUnits(position)); });
     }
 
     /**
@@ -124,7 +124,7 @@ public class AtkEditableText extends AtkText {
             return false;
 
         return AtkUtil.invokeInSwing( () -> {
-            acc_edt_text.setAttributes(start, end, as);
+            acc_edt_text.setAttributes(toUnits(start), toUnits(end), as);
             return true;
         }, false);
     }
@@ -56,6 +56,34 @@ public class AtkHypertext extends AtkText {
 		}, null);
 	}
 
+	/*
+	 * Start and end character offsets of each link, read in one go by
+	 * jawhypertext.c after each change.  null when a link is missing, so
+	 * that each request is asked here again.
+	 */
+	public int[] get_link_offsets () {
+		if (_acc_hyper_text == null)
+			return new int[0];
+		AccessibleHypertext acc_hyper_text = _acc_hyper_text.get();
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_hyper_text == null || acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			AtkTextSurrogateIndex surrogates = getSurrogateIndex(acc_text);
+			int count = acc_hyper_text.getLinkCount();
+			int[] offsets = new int[2 * count];
+			for (int i = 0; i < count; i++) {
+				AccessibleHyperlink link = acc_hyper_text.getLink(i);
+				if (link == null)
+					return null;
+				offsets[2 * i] = surrogates.toChars(link.getStartIndex());
+				offsets[2 * i + 1] = surrogates.toCharsEnd(link.getEndIndex());
+			}
+			return offsets;
+		}, null);
+	}
+
 	public int get_n_links () {
 		if (_acc_hyper_text == null)
 			return 0;
@@ -68,15 +96,18 @@ public class AtkHypertext extends AtkText {
 		}, 0);
 	}
 
+	/* char_index counts characters, like the offsets of get_link_offsets */
 	public int get_link_index (int char_index) {
 		if (_acc_hyper_text == null)
 			return 0;
 		AccessibleHypertext acc_hyper_text = _acc_hyper_text.get();
-		if (acc_hyper_text == null)
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_hyper_text == null || acc_text == null)
 			return 0;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			return acc_hyper_text.getLinkIndex(char_index);
+			int offset = getSurrogateIndex(acc_text).toUnits(char_index);
+			return acc_hyper_text.getLinkIndex(offset);
 		}, 0);
 	}
 }
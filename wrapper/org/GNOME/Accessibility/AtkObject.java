@@ -196,18 +196,77 @@ public class AtkObject{
         return AtkUtil.invokeInSwing( () -> { return ac.getAccessibleRole(); }, AccessibleRole.UNKNOWN);
     }
 
+    /*
+     * Whether the children of ac are made up on demand, like the cells of a
+     * JTable, JList or JTree, so that jawimpl.c pools them.
+     */
+    public static boolean hasTransientChildren(AccessibleContext ac){
+        return AtkUtil.invokeInSwing( () -> {
+            AccessibleRole role = ac.getAccessibleRole();
+            if (role == AccessibleRole.TABLE || role == AccessibleRole.LIST ||
+                role == AccessibleRole.TREE)
+                return true;
+            AccessibleStateSet stateSet = ac.getAccessibleStateSet();
+            return stateSet != null && stateSet.contains(AccessibleState.MANAGES_DESCENDANTS);
+        }, false);
+    }
+
+    public static boolean isTransient(AccessibleContext ac){
+        return AtkUtil.invokeInSwing( () -> {
+            AccessibleStateSet stateSet = ac.getAccessibleStateSet();
+            if (stateSet != null && stateSet.contains(AccessibleState.TRANSIENT))
+                return true;
+            Accessible parent = ac.getAccessibleParent();
+            return parent != null && managesDescendants(parent.getAccessibleContext());
+        }, false);
+    }
+
     public static boolean equalsIgnoreCaseLocaleWithRole(AccessibleRole role){
         String displayString = role.toDisplayString(Locale.US);
         return displayString.equalsIgnoreCase("paragraph");
     }
 
+    /*
+     * Tables, lists and trees with more children than this report
+     * MANAGES_DESCENDANTS, and their children TRANSIENT, so that the bridge
+     * does not walk and cache all of their children.  Set with
+     * -Dorg.GNOME.Accessibility.managesDescendants=<count>, 0 turns it off.
+     */
+    private static final int MANAGES_DESCENDANTS_THRESHOLD =
+        Integer.getInteger("org.GNOME.Accessibility.managesDescendants", 1000);
+
+    static boolean managesDescendants(AccessibleContext ac){
+        if (MANAGES_DESCENDANTS_THRESHOLD <= 0 || ac == null)
+            return false;
+        AccessibleRole role = ac.getAccessibleRole();
+        if (role != AccessibleRole.TABLE && role != AccessibleRole.LIST &&
+            role != AccessibleRole.TREE)
+            return false;
+        return ac.getAccessibleChildrenCount() > MANAGES_DESCENDANTS_THRESHOLD;
+    }
+
     public static AccessibleState[] getArrayAccessibleState(AccessibleContext ac){
         return AtkUtil.invokeInSwing( () -> {
             AccessibleStateSet stateSet = ac.getAccessibleStateSet();
             if (stateSet == null)
                 return null;
-            else
-                return stateSet.toArray();
+
+            AccessibleState[] states = stateSet.toArray();
+            AccessibleState added = null;
+            if (!stateSet.contains(AccessibleState.MANAGES_DESCENDANTS) && managesDescendants(ac)) {
+                added = AccessibleState.MANAGES_DESCENDANTS;
+            } else if (!stateSet.contains(AccessibleState.TRANSIENT)) {
+                Accessible parent = ac.getAccessibleParent();
+                if (parent != null && managesDescendants(parent.getAccessibleContext()))
+                    added = AccessibleState.TRANSIENT;
+            }
+            if (added == null)
+                return states;
+
+            AccessibleState[] all = new AccessibleState[states.length + 1];
+            System.arraycopy(states, 0, all, 0, states.length);
+            all[states.length] = added;
+            return all;
         }, null);
     }
 
@@ -21,16 +21,25 @@ package org.GNOME.Accessibility;
 
 import javax.accessibility.*;
 import java.lang.ref.WeakReference;
+import java.util.Arrays;
+import javax.swing.JList;
 
 public class AtkSelection {
 
 	WeakReference<AccessibleContext> _ac;
 	WeakReference<AccessibleSelection> _acc_selection;
 
+	/*
+	 * Whether this is a JList, read by jawselection.c: java.awt.List and
+	 * others have the same role but don't send selection changes.
+	 */
+	volatile boolean _is_jlist;
+
 	public AtkSelection (AccessibleContext ac) {
 		super();
 		this._ac = new WeakReference<AccessibleContext>(ac);
 		this._acc_selection = new WeakReference<AccessibleSelection>(ac.getAccessibleSelection());
+		this._is_jlist = AtkUtil.getAccessible(ac) instanceof JList;
 	}
 
 	public static AtkSelection createAtkSelection(AccessibleContext ac){
@@ -90,6 +99,31 @@ public class AtkSelection {
 		//return acc_selection.getAccessibleSelectionCount();
 	}
 
+	/*
+	 * Indexes of the selected children, from the selected ones rather than
+	 * by asking each child, which takes long for large lists.
+	 */
+	public int[] get_selected_children () {
+		AccessibleSelection acc_selection = _acc_selection.get();
+		if (acc_selection == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			int count = acc_selection.getAccessibleSelectionCount();
+			int[] selected = new int[count];
+			int n = 0;
+			for (int i = 0; i < count; i++) {
+				Accessible child = acc_selection.getAccessibleSelection(i);
+				if (child == null)
+					continue;
+				AccessibleContext child_ac = child.getAccessibleContext();
+				if (child_ac != null)
+					selected[n++] = child_ac.getAccessibleIndexInParent();
+			}
+			return Arrays.copyOf(selected, n);
+		}, null);
+	}
+
 	public boolean is_child_selected (int i) {
 		AccessibleSelection acc_selection = _acc_selection.get();
 		if (acc_selection == null)
@@ -42,5 +42,12 @@ public interface AtkSignal {
 	public int OBJECT_PROPERTY_CHANGE_ACCESSIBLE_TABLE_ROW_DESCRIPTION = 19;
 	public int TABLE_MODEL_CHANGED = 20;
 	public int TEXT_PROPERTY_CHANGED = 21;
+	public int TEXT_ATTRIBUTES_CHANGED = 22;
+	public int TABLE_ROW_INSERTED = 23;
+	public int TABLE_ROW_DELETED = 24;
+	public int TABLE_ROW_REORDERED = 25;
+	public int TABLE_COLUMN_INSERTED = 26;
+	public int TABLE_COLUMN_DELETED = 27;
+	public int TABLE_CELLS_CHANGED = 28;
 }
 
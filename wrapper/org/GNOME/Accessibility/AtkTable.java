@@ -21,16 +21,122 @@
 package org.GNOME.Accessibility;
 
 import javax.accessibility.*;
+import java.beans.PropertyChangeEvent;
+import java.beans.PropertyChangeListener;
 import java.lang.ref.WeakReference;
+import javax.swing.JTable;
+import javax.swing.RowSorter;
+import javax.swing.event.RowSorterEvent;
+import javax.swing.event.RowSorterListener;
 
 public class AtkTable {
 
 	WeakReference<AccessibleContext> _ac;
 	WeakReference<AccessibleTable> _acc_table;
 
+	/*
+	 * Whether the JTable has a RowSorter, read by jawtable.c: sorting and
+	 * filtering change the rows without any AccessibleTableModelChange, so
+	 * the row count can't be cached then.
+	 */
+	volatile boolean _row_sorted;
+
+	/* Sends the sorts of the RowSorter, which follows the one of the JTable */
+	RowSorterListener _sorter_listener;
+	PropertyChangeListener _row_sorter_listener;
+	private RowSorter<?> row_sorter;
+
+	/*
+	 * The cells of some rows, in row order with n_columns of them per row,
+	 * with the JawImpl made for each, its name and its states, and the
+	 * column headers the same way.  Missing cells are null, with 0 as JawImpl.
+	 */
+	public class RowSnapshot {
+
+		public int n_columns;
+		public AccessibleContext[] cells;
+		public long[] instances;
+		public String[] names;
+		public AccessibleState[][] states;
+		public AccessibleContext[] headers;
+		public long[] header_instances;
+		public String[] header_names;
+
+		public RowSnapshot (int n_rows, int n_columns) {
+			int n = n_rows * n_columns;
+			this.n_columns = n_columns;
+			this.cells = new AccessibleContext[n];
+			this.instances = new long[n];
+			this.names = new String[n];
+			this.states = new AccessibleState[n][];
+			this.headers = new AccessibleContext[n_columns];
+			this.header_instances = new long[n_columns];
+			this.header_names = new String[n_columns];
+		}
+	}
+
 	public AtkTable (AccessibleContext ac) {
 		this._ac = new WeakReference<AccessibleContext>(ac);
 		this._acc_table = new WeakReference<AccessibleTable>(ac.getAccessibleTable());
+
+		Accessible accessible = AtkUtil.getAccessible(ac);
+		if (accessible instanceof JTable) {
+			JTable table = (JTable)accessible;
+			this._sorter_listener = new RowSorterListener() {
+				public void sorterChanged (RowSorterEvent e) {
+					if (e.getType() == RowSorterEvent.Type.SORTED)
+						rowsSorted(e);
+				}
+			};
+			this._row_sorter_listener = new PropertyChangeListener() {
+				public void propertyChange(PropertyChangeEvent e) {
+					setRowSorter((RowSorter<?>)e.getNewValue());
+				}
+			};
+			setRowSorter(table.getRowSorter());
+			table.addPropertyChangeListener("rowSorter", _row_sorter_listener);
+		}
+	}
+
+	/* Called by jawtable.c when the JawImpl of the table goes away */
+	public void unlisten () {
+		AtkUtil.invokeInSwing( () -> {
+			AccessibleContext ac = _ac.get();
+			Accessible accessible = ac != null ? AtkUtil.getAccessible(ac) : null;
+			if (accessible instanceof JTable)
+				((JTable)accessible).removePropertyChangeListener("rowSorter", _row_sorter_listener);
+			if (_sorter_listener != null)
+				setRowSorter(null);
+		});
+	}
+
+	private void setRowSorter (RowSorter<?> sorter) {
+		if (row_sorter != null)
+			row_sorter.removeRowSorterListener(_sorter_listener);
+		row_sorter = sorter;
+		_row_sorted = sorter != null;
+		if (sorter != null)
+			sorter.addRowSorterListener(_sorter_listener);
+	}
+
+	/*
+	 * JTable sends no accessible event when its RowSorter sorts or filters
+	 * the rows.  If there are as many rows as before, they were reordered.
+	 */
+	private void rowsSorted (RowSorterEvent e) {
+		AccessibleContext ac = _ac.get();
+		RowSorter<?> sorter = e.getSource();
+		if (ac == null || sorter == null)
+			return;
+
+		int n_rows = sorter.getViewRowCount();
+		if (e.getPreviousRowCount() != n_rows) {
+			AtkWrapper.emitSignal(ac, AtkSignal.TABLE_MODEL_CHANGED, null);
+			return;
+		}
+		Object[] args = new Object[1];
+		args[0] = n_rows;
+		AtkWrapper.emitSignal(ac, AtkSignal.TABLE_ROW_REORDERED, args);
 	}
 
 	public static AtkTable createAtkTable(AccessibleContext ac){
@@ -50,6 +156,56 @@ public class AtkTable {
 		}, null);
 	}
 
+	/*
+	 * What screen readers read when moving to rows first_row to last_row,
+	 * in one call to the Swing thread instead of a few per cell.
+	 */
+	public RowSnapshot get_row_snapshot (int first_row, int last_row) {
+		AccessibleTable acc_table = _acc_table.get();
+		if (acc_table == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			int n_columns = acc_table.getAccessibleColumnCount();
+			if (first_row < 0 || last_row < first_row ||
+			    last_row >= acc_table.getAccessibleRowCount())
+				return null;
+
+			RowSnapshot snapshot = new RowSnapshot(last_row - first_row + 1, n_columns);
+			int i = 0;
+			for (int row = first_row; row <= last_row; row++) {
+				for (int column = 0; column < n_columns; column++, i++) {
+					Accessible accessible = acc_table.getAccessibleAt(row, column);
+					if (accessible == null)
+						continue;
+					AccessibleContext ac = accessible.getAccessibleContext();
+					if (ac == null)
+						continue;
+					snapshot.cells[i] = ac;
+					snapshot.instances[i] = AtkWrapper.getInstance(ac);
+					snapshot.names[i] = AtkObject.getAccessibleName(ac);
+					snapshot.states[i] = AtkObject.getArrayAccessibleState(ac);
+				}
+			}
+
+			AccessibleTable header_table = acc_table.getAccessibleColumnHeader();
+			if (header_table != null) {
+				for (int column = 0; column < n_columns; column++) {
+					Accessible accessible = header_table.getAccessibleAt(0, column);
+					if (accessible == null)
+						continue;
+					AccessibleContext ac = accessible.getAccessibleContext();
+					if (ac == null)
+						continue;
+					snapshot.headers[column] = ac;
+					snapshot.header_instances[column] = AtkWrapper.getInstance(ac);
+					snapshot.header_names[column] = AtkObject.getAccessibleName(ac);
+				}
+			}
+			return snapshot;
+		}, null);
+	}
+
 	public int get_index_at (int row, int column) {
 		AccessibleTable acc_table = _acc_table.get();
 		if (acc_table == null)
@@ -21,15 +21,81 @@ package org.GNOME.Accessibility;
 
 import javax.accessibility.*;
 import java.text.*;
+import java.awt.Dimension;
 import java.awt.Rectangle;
 import java.awt.Point;
+import java.beans.PropertyChangeEvent;
+import java.beans.PropertyChangeListener;
 import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Map;
+import java.util.WeakHashMap;
+import javax.swing.JPasswordField;
+import javax.swing.SwingUtilities;
+import javax.swing.event.CaretEvent;
+import javax.swing.event.CaretListener;
+import javax.swing.event.DocumentEvent;
+import javax.swing.event.DocumentListener;
+import javax.swing.text.BadLocationException;
+import javax.swing.text.Document;
+import javax.swing.text.JTextComponent;
+import javax.swing.text.Segment;
 
 public class AtkText {
 
 	WeakReference<AccessibleContext> _ac;
 	WeakReference<AccessibleText> _acc_text;
 	WeakReference<AccessibleEditableText> _acc_edt_text;
+	WeakReference<JTextComponent> _text_component;
+	PropertyChangeListener _text_listener;
+
+	/* Tells _text_component's edits exactly, on the thread making them */
+	DocumentListener _document_listener;
+	PropertyChangeListener _document_property_listener;
+	private Document document;
+	/* Surrogates of document, only touched under one of its locks */
+	private AtkTextSurrogateIndex document_surrogates;
+
+	/* Set when the Document changed off the Swing thread */
+	private volatile boolean text_caches_stale;
+
+	/* Native text mirror, set and cleared by jawtext.c */
+	volatile long _mirror;
+
+	/* Bumped whenever the text or its attributes change, read by jawtext.c */
+	volatile int _attributes_serial;
+
+	/* Same for the text, and for the text, the caret or the selection */
+	volatile int _text_serial;
+	volatile int _caret_serial;
+
+	/* Whether _caret_serial is bumped for every caret and mark move */
+	volatile boolean _caret_listened;
+	CaretListener _caret_listener;
+
+	/* Only accessed from the Swing thread */
+	private boolean listened;
+	private AtkTextLineIndex line_index;
+	private AtkTextSegmentation segmentation;
+	private AtkTextSurrogateIndex surrogates;
+	private int text_length;
+	private boolean change_seen;
+
+	/* AtkText of each AccessibleContext, for the offsets of its events */
+	private static final Map<AccessibleContext, WeakReference<AtkText>> instances =
+			Collections.synchronizedMap(new WeakHashMap<AccessibleContext, WeakReference<AtkText>>());
+
+	/* Size of the text window used for word and sentence boundaries */
+	private static final int SEGMENT_WINDOW = 4096;
+	private static final int SEGMENT_MARGIN = 64;
+
+	/* Most characters get_line_extents() returns at once */
+	private static final int LINE_EXTENTS_MAX = 256;
+
+	/* AtkTextClipType bits, ATK_TEXT_CLIP_BOTH being both of them */
+	private static final int CLIP_MIN = 1;
+	private static final int CLIP_MAX = 2;
 
 	public class StringSequence {
 
@@ -43,17 +109,139 @@ public class AtkText {
 		}
 	}
 
+	/* A line of text within some bounds, and its bounds */
+	public class TextRange {
+
+		public String str;
+		public int start_offset, end_offset;
+		public int x, y, width, height;
+
+		public TextRange (int start_offset, Rectangle rect) {
+			this.start_offset = start_offset;
+			this.end_offset = start_offset;
+			this.x = rect.x;
+			this.y = rect.y;
+			this.width = rect.width;
+			this.height = rect.height;
+		}
+	}
+
 	public AtkText (AccessibleContext ac) {
 		super();
 		this._ac = new WeakReference<AccessibleContext>(ac);
 		this._acc_text = new WeakReference<AccessibleText>(ac.getAccessibleText());
 		this._acc_edt_text = new WeakReference<AccessibleEditableText>(ac.getAccessibleEditableText());
+
+		/* Password fields must keep going through their AccessibleText */
+		Accessible accessible = AtkUtil.getAccessible(ac);
+		if (accessible instanceof JTextComponent && !(accessible instanceof JPasswordField))
+			this._text_component = new WeakReference<JTextComponent>((JTextComponent)accessible);
+		AccessibleText acc_text = ac.getAccessibleText();
+		this.text_length = acc_text != null ? acc_text.getCharCount() : -1;
 	}
 
+	/*
+	 * Only the AtkText registered for ac listens to its changes, subclasses
+	 * for the other interfaces of the same object go through that one.
+	 */
+	private void listen (AccessibleContext ac) {
+		this.listened = true;
+		this._text_listener = new PropertyChangeListener() {
+			public void propertyChange(PropertyChangeEvent e) {
+				String propertyName = e.getPropertyName();
+				if (propertyName.equals(AccessibleContext.ACCESSIBLE_TEXT_PROPERTY))
+					textChanged(e);
+				else if (propertyName.equals(AccessibleContext.ACCESSIBLE_TEXT_ATTRIBUTES_CHANGED))
+					_attributes_serial++;
+				else if (propertyName.equals(AccessibleContext.ACCESSIBLE_CARET_PROPERTY) ||
+						propertyName.equals(AccessibleContext.ACCESSIBLE_SELECTION_PROPERTY))
+					_caret_serial++;
+				else if (_text_component == null &&
+						(propertyName.equals(AccessibleContext.ACCESSIBLE_VISIBLE_DATA_PROPERTY) ||
+						 propertyName.equals(AccessibleContext.ACCESSIBLE_NAME_PROPERTY)))
+					textReplaced();
+			}
+		};
+		ac.addPropertyChangeListener(_text_listener);
+
+		JTextComponent text_component = _text_component != null ? _text_component.get() : null;
+		if (text_component != null) {
+			this._document_listener = new DocumentListener() {
+				public void insertUpdate (DocumentEvent e) {
+					documentChanged(e, true);
+				}
+				public void removeUpdate (DocumentEvent e) {
+					documentChanged(e, false);
+				}
+				public void changedUpdate (DocumentEvent e) {
+					_attributes_serial++;
+				}
+			};
+			this._document_property_listener = new PropertyChangeListener() {
+				public void propertyChange(PropertyChangeEvent e) {
+					listenDocument((Document)e.getNewValue());
+					textReplaced();
+				}
+			};
+			listenDocument(text_component.getDocument());
+			text_component.addPropertyChangeListener("document", _document_property_listener);
+
+			this._caret_listener = new CaretListener() {
+				public void caretUpdate (CaretEvent e) {
+					_caret_serial++;
+				}
+			};
+			text_component.addCaretListener(_caret_listener);
+			this._caret_listened = true;
+		}
+	}
+
+	/* The index and the listener are set up with no edit in between */
+	private synchronized void listenDocument (Document doc) {
+		if (document != null)
+			document.removeDocumentListener(_document_listener);
+		document = doc;
+		if (doc != null) {
+			doc.render( () -> {
+				document_surrogates = getDocumentSurrogates(doc);
+				doc.addDocumentListener(_document_listener);
+			});
+		}
+	}
+
+	/* AtkEditableText objects are not registered, the AtkText of ac is */
 	public static AtkText createAtkText(AccessibleContext ac){
-        return AtkUtil.invokeInSwing ( () -> { return new AtkText(ac); }, null);
+        return AtkUtil.invokeInSwing ( () -> {
+            AtkText atk_text = new AtkText(ac);
+            atk_text.listen(ac);
+            instances.put(ac, new WeakReference<AtkText>(atk_text));
+            return atk_text;
+        }, null);
     }
 
+	/* Called by jawtext.c when the JawImpl of the text goes away */
+	public void unlisten () {
+		AtkUtil.invokeInSwing( () -> {
+			if (!listened)
+				return;
+			listened = false;
+
+			AccessibleContext ac = _ac.get();
+			if (ac != null) {
+				ac.removePropertyChangeListener(_text_listener);
+				if (getInstance(ac) == this)
+					instances.remove(ac);
+			}
+			JTextComponent text_component = _text_component != null ? _text_component.get() : null;
+			if (text_component != null) {
+				text_component.removePropertyChangeListener("document", _document_property_listener);
+				text_component.removeCaretListener(_caret_listener);
+			}
+			_caret_listened = false;
+			listenDocument(null);
+		});
+	}
+
 	public static int getRightStart(int start) {
 		if (start < 0)
 			return 0;
@@ -77,33 +265,109 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
 			final int rightStart = getRightStart(start);;
-			final int rightEnd = getRightEnd(start, end, acc_text.getCharCount());
+			final int rightEnd = getRightEnd(start, end, index.getCharCount());
 
-			if (acc_text instanceof AccessibleExtendedText) {
-				AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
-				return acc_ext_text.getTextRange(rightStart, rightEnd);
-			}
-			StringBuffer buf = new StringBuffer();
-			for (int i = rightStart; i <= rightEnd-1; i++) {
+			return getTextUnits(acc_text, index.toUnits(rightStart), index.toUnits(rightEnd));
+		}, null);
+	}
+
+	/* Same as get_text(), with UTF-16 offsets already clamped to the text */
+	private String getTextUnits (AccessibleText acc_text, int start, int end) {
+		JTextComponent text_component = _text_component != null ? _text_component.get() : null;
+		if (text_component != null) {
+			String str = getDocumentText(text_component.getDocument(), start, end);
+			if (str != null)
+				return str;
+		}
+
+		if (acc_text instanceof AccessibleExtendedText) {
+			AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
+			return acc_ext_text.getTextRange(start, end);
+		}
+		return getTextBySentence(acc_text, start, end);
+	}
+
+	/*
+	 * Without AccessibleExtendedText, take whole sentences wherever one
+	 * starts, i.e. where the sentence differs from the one before it, and
+	 * single characters until then.
+	 */
+	private static String getTextBySentence (AccessibleText acc_text, int start, int end) {
+		StringBuilder buf = new StringBuilder(Math.max(end - start, 0));
+		String prev = start > 0 ? acc_text.getAtIndex(AccessibleText.SENTENCE, start - 1) : null;
+		int i = start;
+		while (i < end) {
+			String sentence = acc_text.getAtIndex(AccessibleText.SENTENCE, i);
+			if (sentence != null && sentence.length() > 0 &&
+					(i == 0 || !sentence.equals(prev))) {
+				int length = Math.min(sentence.length(), end - i);
+				buf.append(sentence, 0, length);
+				i += length;
+			} else {
 				String str = acc_text.getAtIndex(AccessibleText.CHARACTER, i);
-				buf.append(str);
+				if (str != null)
+					buf.append(str);
+				i++;
 			}
-			return buf.toString();
-		}, null);
+			prev = sentence;
+		}
+		return buf.toString();
 	}
 
-	public char get_character_at_offset (int offset) {
+	private String getTextUnits (int start, int end) {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+		int count = acc_text.getCharCount();
+		start = Math.max(start, 0);
+		return getTextUnits(acc_text, start, Math.max(Math.min(end, count), start));
+	}
+
+	/*
+	 * Read the range straight from the Document, letting it hand out its
+	 * own buffer in as many pieces as it stores the text in.
+	 */
+	private static String getDocumentText (Document doc, int start, int end) {
+		if (doc == null || end > doc.getLength())
+			return null;
+		if (end <= start)
+			return "";
+
+		StringBuilder buf = new StringBuilder(end - start);
+		Segment segment = new Segment();
+		segment.setPartialReturn(true);
+		try {
+			int offset = start;
+			while (offset < end) {
+				doc.getText(offset, end - offset, segment);
+				if (segment.count <= 0)
+					return null;
+				buf.append(segment.array, segment.offset, segment.count);
+				offset += segment.count;
+			}
+		} catch (BadLocationException e) {
+			return null;
+		}
+		return buf.toString();
+	}
+
+	/* Return the code point at offset, both halves of a surrogate pair */
+	public int get_character_at_offset (int offset) {
 		AccessibleText acc_text = _acc_text.get();
 		if (acc_text == null)
 			return ' ';
 
 		return AtkUtil.invokeInSwing ( () -> {
-			String str =  acc_text.getAtIndex(AccessibleText.CHARACTER, offset);
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+			if (offset < 0 || offset >= index.getCharCount())
+				return (int)' ';
+			String str = getTextUnits(acc_text, index.toUnits(offset), index.toUnits(offset+1));
 			if (str == null || str.length() == 0)
-				return ' ';
-			return str.charAt(0);
-		}, ' ');
+				return (int)' ';
+			return str.codePointAt(0);
+		}, (int)' ');
 	}
 
 	public StringSequence get_text_at_offset (int offset,int boundary_type) {
@@ -112,19 +376,7 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			if (false && acc_text instanceof AccessibleExtendedText) {
-				// FIXME: this is not using start/end boundaries
-				AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
-				int part = getPartTypeFromBoundary(boundary_type);
-				if (part == -1)
-					return null;
-				AccessibleTextSequence seq = acc_ext_text.getTextSequenceAt(part, offset);
-				if (seq == null)
-					return null;
-				return new StringSequence(seq.text, seq.startIndex, seq.endIndex+1);
-			} else {
-				return private_get_text_at_offset(offset, boundary_type);
-			}
+			return getTextAtChar(acc_text, offset, boundary_type);
 		}, null);
 	}
 
@@ -134,22 +386,10 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			if (false && acc_text instanceof AccessibleExtendedText) {
-				// FIXME: this is not using start/end boundaries
-				AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
-				int part = getPartTypeFromBoundary(boundary_type);
-				if (part == -1)
-					return null;
-				AccessibleTextSequence seq = acc_ext_text.getTextSequenceBefore(part, offset);
-				if (seq == null)
-					return null;
-				return new StringSequence(seq.text, seq.startIndex, seq.endIndex+1);
-			} else {
-				StringSequence seq = private_get_text_at_offset(offset, boundary_type);
-				if (seq == null)
-					return null;
-				return private_get_text_at_offset(seq.start_offset-1, boundary_type);
-			}
+			StringSequence seq = getTextAtChar(acc_text, offset, boundary_type);
+			if (seq == null)
+				return null;
+			return getTextAtChar(acc_text, seq.start_offset-1, boundary_type);
 		}, null);
 	}
 
@@ -159,31 +399,186 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			if (false && acc_text instanceof AccessibleExtendedText) {
-				// FIXME: this is not using start/end boundaries
-				AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
-				int part = getPartTypeFromBoundary(boundary_type);
-				if (part == -1)
-					return null;
-				AccessibleTextSequence seq = acc_ext_text.getTextSequenceAfter(part, offset);
-				if (seq == null)
-					return null;
-				return new StringSequence(seq.text, seq.startIndex, seq.endIndex+1);
-			} else {
-				StringSequence seq = private_get_text_at_offset(offset, boundary_type);
-				if (seq == null)
+			StringSequence seq = getTextAtChar(acc_text, offset, boundary_type);
+			if (seq == null)
+				return null;
+			return getTextAtChar(acc_text, seq.end_offset, boundary_type);
+		}, null);
+	}
+
+	/*
+	 * Up to n consecutive boundary_type ranges, starting with the one at
+	 * offset, so that jawtext.c can read ahead when text is read in order.
+	 */
+	public StringSequence[] get_text_segments_at_offset (int offset, int boundary_type, int n) {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			ArrayList<StringSequence> segments = new ArrayList<StringSequence>(n);
+			StringSequence seq = getTextAtChar(acc_text, offset, boundary_type);
+			while (seq != null && segments.size() < n) {
+				segments.add(seq);
+				/* END ranges are also the range at their end offset */
+				StringSequence next = getTextAtChar(acc_text, seq.end_offset, boundary_type);
+				if (next != null && next.end_offset <= seq.end_offset)
+					next = getTextAtChar(acc_text, seq.end_offset+1, boundary_type);
+				if (next != null && next.end_offset <= seq.end_offset)
+					break;
+				seq = next;
+			}
+			return segments.toArray(new StringSequence[segments.size()]);
+		}, null);
+	}
+
+	/*
+	 * The granularity range at offset, text and offsets together.  Lines
+	 * follow the layout of AccessibleExtendedText when there is one, while
+	 * paragraphs always end at '\n'.
+	 */
+	public StringSequence get_string_at_offset (int offset, int granularity) {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			switch (granularity) {
+				case AtkTextGranularity.CHAR :
+					return getTextAtChar(acc_text, offset, AtkTextBoundary.CHAR);
+				case AtkTextGranularity.WORD :
+					return getTextAtChar(acc_text, offset, AtkTextBoundary.WORD_START);
+				case AtkTextGranularity.SENTENCE :
+					return getTextAtChar(acc_text, offset, AtkTextBoundary.SENTENCE_START);
+				case AtkTextGranularity.LINE :
+					return getTextAtChar(acc_text, offset, AtkTextBoundary.LINE_START);
+				case AtkTextGranularity.PARAGRAPH :
+				{
+					AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+					if (offset < 0 || offset > index.getCharCount())
+						return null;
+					return toCharRange(acc_text, index, private_get_text_at_offset(
+							index.toUnits(offset), AtkTextBoundary.LINE_START));
+				}
+				default :
 					return null;
-				return private_get_text_at_offset(seq.end_offset, boundary_type);
 			}
 		}, null);
 	}
 
+	/*
+	 * The lines of text within the given bounds, one range for each run of
+	 * characters of a line that are within them.  Characters crossing an
+	 * edge are left out when clipping is asked for on that edge.
+	 */
+	public TextRange[] get_bounded_ranges (int x, int y, int width, int height,
+			int coord_type, int x_clip_type, int y_clip_type) {
+		AccessibleContext ac = _ac.get();
+		if (ac == null)
+			return null;
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			AccessibleComponent component = ac.getAccessibleComponent();
+			if (component == null)
+				return null;
+			Point p = AtkComponent.getComponentOrigin(ac, component, coord_type);
+			Rectangle bounds = new Rectangle(x - p.x, y - p.y, width, height);
+
+			int count = acc_text.getCharCount();
+			int first = acc_text.getIndexAtPoint(new Point(bounds.x, bounds.y));
+			int last = acc_text.getIndexAtPoint(new Point(bounds.x + bounds.width - 1,
+					bounds.y + bounds.height - 1));
+			/* Not over any text, so look for the lines within the bounds */
+			if (first < 0)
+				first = searchCharacterBelow(acc_text, 0, count, bounds.y, true);
+			if (last < 0 || last >= count)
+				last = searchCharacterBelow(acc_text, first, count,
+						bounds.y + bounds.height, false) - 1;
+
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+			ArrayList<TextRange> ranges = new ArrayList<TextRange>();
+			TextRange range = null;
+			for (int i = first; i <= last; i++) {
+				int units = index.toUnits(index.toChars(i));
+				if (units != i)
+					continue;
+				Rectangle rect = acc_text.getCharacterBounds(i);
+				if (rect == null ||
+						!isWithin(rect.x, rect.width, bounds.x, bounds.width, x_clip_type) ||
+						!isWithin(rect.y, rect.height, bounds.y, bounds.height, y_clip_type)) {
+					range = null;
+					continue;
+				}
+				if (range != null && rect.y != range.y)
+					range = null;
+				if (range == null) {
+					range = new TextRange(index.toChars(i), rect);
+					ranges.add(range);
+				} else {
+					Rectangle union = rect.union(new Rectangle(range.x, range.y,
+							range.width, range.height));
+					range.x = union.x;
+					range.y = union.y;
+					range.width = union.width;
+					range.height = union.height;
+				}
+				range.end_offset = index.toChars(i) + 1;
+			}
+
+			for (TextRange r : ranges) {
+				r.str = getTextUnits(acc_text, index.toUnits(r.start_offset),
+						index.toUnits(r.end_offset));
+				if (r.str == null)
+					r.str = "";
+				r.x += p.x;
+				r.y += p.y;
+			}
+			return ranges.toArray(new TextRange[ranges.size()]);
+		}, null);
+	}
+
+	/*
+	 * First character in [low, high) whose bottom, or top, is below y.
+	 * Characters go down as their offset grows, so this is a binary search
+	 * instead of asking the bounds of every character up to the end.
+	 */
+	private static int searchCharacterBelow (AccessibleText acc_text, int low, int high,
+			int y, boolean bottom) {
+		while (low < high) {
+			int mid = (low + high) >>> 1;
+			Rectangle rect = acc_text.getCharacterBounds(mid);
+			if (rect != null && (bottom ? rect.y + rect.height : rect.y) <= y)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	/* Whether [start, start+len) is within [lo, lo+size) for clip_type */
+	private static boolean isWithin (int start, int len, int lo, int size, int clip_type) {
+		int end = start + len;
+		int hi = lo + size;
+		if (end <= lo || start >= hi)
+			return false;
+		if ((clip_type & CLIP_MIN) != 0 && start < lo)
+			return false;
+		if ((clip_type & CLIP_MAX) != 0 && end > hi)
+			return false;
+		return true;
+	}
+
 	public int get_caret_offset () {
 		AccessibleText acc_text = _acc_text.get();
 		if (acc_text == null)
 			return 0;
 
-		return AtkUtil.invokeInSwing ( () -> { return acc_text.getCaretPosition(); }, 0);
+		return AtkUtil.invokeInSwing ( () -> {
+			return getSurrogateIndex(acc_text).toChars(acc_text.getCaretPosition());
+		}, 0);
 	}
 
 	public Rectangle get_character_extents (int offset, int coord_type) {
@@ -195,7 +590,7 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			Rectangle rect = acc_text.getCharacterBounds(offset);
+			Rectangle rect = acc_text.getCharacterBounds(getSurrogateIndex(acc_text).toUnits(offset));
 			if (rect == null)
 				return null;
 			AccessibleComponent component = ac.getAccessibleComponent();
@@ -208,12 +603,103 @@ public class AtkText {
 		}, null);
 	}
 
+	/*
+	 * Bounds of the characters of the line holding offset, relative to the
+	 * component, as { start, end, x, y, width, height, ... } with one
+	 * rectangle for each character of [start, end), and a width of -1 where
+	 * there is none.  Long lines are cut to LINE_EXTENTS_MAX characters
+	 * around offset.
+	 */
+	public int[] get_line_extents (int offset) {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+			if (offset < 0 || offset >= index.getCharCount())
+				return null;
+
+			int start = offset;
+			int end = offset + 1;
+			StringSequence line = getTextAtChar(acc_text, offset, AtkTextBoundary.LINE_START);
+			if (line != null && line.start_offset <= offset && offset < line.end_offset) {
+				start = Math.max(line.start_offset, offset - LINE_EXTENTS_MAX / 2);
+				end = Math.min(line.end_offset, start + LINE_EXTENTS_MAX);
+			}
+
+			int[] extents = new int[2 + 4 * (end - start)];
+			extents[0] = start;
+			extents[1] = end;
+			for (int i = start; i < end; i++) {
+				int k = 2 + 4 * (i - start);
+				Rectangle rect = acc_text.getCharacterBounds(index.toUnits(i));
+				if (rect == null) {
+					extents[k+2] = -1;
+					continue;
+				}
+				extents[k] = rect.x;
+				extents[k+1] = rect.y;
+				extents[k+2] = rect.width;
+				extents[k+3] = rect.height;
+			}
+			return extents;
+		}, null);
+	}
+
+	/*
+	 * Where the component is for coord_type, and its size, which tells
+	 * jawtext.c whether the bounds of get_line_extents() may have moved.
+	 */
+	public Rectangle get_extents_origin (int coord_type) {
+		AccessibleContext ac = _ac.get();
+		if (ac == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			AccessibleComponent component = ac.getAccessibleComponent();
+			if (component == null)
+				return null;
+			Point p = AtkComponent.getComponentOrigin(ac, component, coord_type);
+			Dimension d = component.getSize();
+			if (p == null || d == null)
+				return null;
+			return new Rectangle(p.x, p.y, d.width, d.height);
+		}, null);
+	}
+
+	public AtkTextAttributes.Runs get_attribute_runs () {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			JTextComponent text_component = _text_component != null ? _text_component.get() : null;
+			Document doc = text_component != null ? text_component.getDocument() : null;
+			AtkTextAttributes.Runs runs = AtkTextAttributes.getRuns(acc_text, doc);
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+			for (int i = 0; i < runs.ends.length; i++)
+				runs.ends[i] = index.toCharsEnd(runs.ends[i]);
+			return runs;
+		}, null);
+	}
+
+	public String get_default_attributes () {
+		AccessibleContext ac = _ac.get();
+		if (ac == null)
+			return null;
+
+		return AtkUtil.invokeInSwing ( () -> { return AtkTextAttributes.getDefaults(ac); }, null);
+	}
+
 	public int get_character_count () {
 		AccessibleText acc_text = _acc_text.get();
 		if (acc_text == null)
 			return 0;
 
-		return AtkUtil.invokeInSwing ( () -> { return acc_text.getCharCount(); }, 0);
+		return AtkUtil.invokeInSwing ( () -> {
+			return getSurrogateIndex(acc_text).getCharCount();
+		}, 0);
 	}
 
 	public int get_offset_at_point (int x, int y, int coord_type) {
@@ -229,7 +715,8 @@ public class AtkText {
 			if (component == null)
 				return -1;
 			Point p = AtkComponent.getComponentOrigin(ac, component, coord_type);
-			return acc_text.getIndexAtPoint(new Point(x-p.x, y-p.y));
+			int offset = acc_text.getIndexAtPoint(new Point(x-p.x, y-p.y));
+			return getSurrogateIndex(acc_text).toChars(offset);
 		}, -1);
 	}
 
@@ -243,11 +730,13 @@ public class AtkText {
 
 		return AtkUtil.invokeInSwing ( () -> {
 			if (acc_text instanceof AccessibleExtendedText) {
+				AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
 				final int rightStart = getRightStart(start);;
-				final int rightEnd = getRightEnd(start, end, acc_text.getCharCount());
+				final int rightEnd = getRightEnd(start, end, index.getCharCount());
 
 				AccessibleExtendedText acc_ext_text = (AccessibleExtendedText)acc_text;
-				Rectangle rect = acc_ext_text.getTextBounds(rightStart, rightEnd);
+				Rectangle rect = acc_ext_text.getTextBounds(index.toUnits(rightStart),
+						index.toUnits(rightEnd));
 				if (rect == null)
 					return null;
 				AccessibleComponent component = ac.getAccessibleComponent();
@@ -281,8 +770,9 @@ public class AtkText {
 			return null;
 
 		return AtkUtil.invokeInSwing ( () -> {
-			int start = acc_text.getSelectionStart();
-			int end = acc_text.getSelectionEnd();
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+			int start = index.toChars(acc_text.getSelectionStart());
+			int end = index.toCharsEnd(acc_text.getSelectionEnd());
 			String text = acc_text.getSelectedText();
 			if (text == null)
 				return null;
@@ -303,7 +793,7 @@ public class AtkText {
 				return false;
 
 			final int rightStart = getRightStart(start);;
-			final int rightEnd = getRightEnd(start, end, acc_text.getCharCount());
+			final int rightEnd = getRightEnd(start, end, getSurrogateIndex(acc_text).getCharCount());
 
 			return set_selection(0, rightStart, rightEnd);
 		}, false);
@@ -334,10 +824,11 @@ public class AtkText {
 			if (acc_edt_text == null || selection_num > 0)
 				return false;
 
+			AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
 			final int rightStart = getRightStart(start);;
-			final int rightEnd = getRightEnd(start, end, acc_text.getCharCount());
+			final int rightEnd = getRightEnd(start, end, index.getCharCount());
 
-			acc_edt_text.selectText(rightStart, rightEnd);
+			acc_edt_text.selectText(index.toUnits(rightStart), index.toUnits(rightEnd));
 			return true;
 		}, false);
 	}
@@ -352,35 +843,489 @@ public class AtkText {
 
 		return AtkUtil.invokeInSwing ( () -> {
 			if (acc_edt_text != null) {
-				final int rightOffset = getRightEnd(0, offset, acc_text.getCharCount());
-				acc_edt_text.selectText(offset, offset);
+				final int unitOffset = getSurrogateIndex(acc_text).toUnits(offset);
+				acc_edt_text.selectText(unitOffset, unitOffset);
 				return true;
 			}
 			return false;
 		}, false);
 	}
 
-	private int getPartTypeFromBoundary (int boundary_type) {
-		switch (boundary_type) {
-			case AtkTextBoundary.CHAR :
-				return AccessibleText.CHARACTER;
-			case AtkTextBoundary.WORD_START :
-			case AtkTextBoundary.WORD_END :
-				return AccessibleText.WORD;
-			case AtkTextBoundary.SENTENCE_START :
-			case AtkTextBoundary.SENTENCE_END :
-				return AccessibleText.SENTENCE;
-			case AtkTextBoundary.LINE_START :
-			case AtkTextBoundary.LINE_END :
-				return AccessibleExtendedText.LINE;
-			default :
-				return -1;
+	/*
+	 * Only AccessibleTextSequence events tell what changed.  An Integer
+	 * event only gives a position, which may be the caret's or arrive long
+	 * after the edit, so everything kept about the text is dropped then.
+	 */
+	private void textChanged (PropertyChangeEvent e) {
+		segmentation = null;
+		_attributes_serial++;
+		_text_serial++;
+		_caret_serial++;
+
+		/* The DocumentListener has already applied the edit */
+		if (_document_listener != null)
+			return;
+
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return;
+
+		int count = acc_text.getCharCount();
+		int old_count = text_length;
+		text_length = count;
+
+		/* Already seen through an Integer event for the same edit */
+		Object oldValue = e.getOldValue();
+		Object newValue = e.getNewValue();
+		change_seen = old_count == count &&
+				getSequenceLength(oldValue) != getSequenceLength(newValue);
+		if (line_index == null && surrogates == null && _mirror == 0)
+			return;
+		if (!(oldValue instanceof AccessibleTextSequence ||
+				newValue instanceof AccessibleTextSequence)) {
+			textReplaced();
+			return;
+		}
+		if (change_seen)
+			return;
+
+		int position = -1;
+		int deleted = 0;
+		String inserted = "";
+
+		AccessibleTextSequence oldSeq = null;
+		AccessibleTextSequence newSeq = null;
+		if (oldValue instanceof AccessibleTextSequence)
+			oldSeq = (AccessibleTextSequence)oldValue;
+		if (newValue instanceof AccessibleTextSequence)
+			newSeq = (AccessibleTextSequence)newValue;
+
+		if (oldSeq != null && oldSeq.text != null) {
+			position = oldSeq.startIndex;
+			deleted = oldSeq.text.length();
 		}
+		if (newSeq != null && newSeq.text != null) {
+			if (position == -1 || position == newSeq.startIndex) {
+				position = newSeq.startIndex;
+				inserted = newSeq.text;
+			} else {
+				position = -1;
+			}
+		}
+		applyChange(position, deleted, inserted, old_count, count);
+	}
+
+	/*
+	 * Edits of _text_component's Document.  On the Swing thread they are
+	 * applied like AccessibleTextSequence ones; from other threads, only
+	 * the native mirror, which has its own lock, is patched, and the rest
+	 * is dropped the next time the Swing thread looks at it.
+	 */
+	private void documentChanged (DocumentEvent e, boolean insert) {
+		_attributes_serial++;
+		_text_serial++;
+		_caret_serial++;
+
+		Document doc = e.getDocument();
+		int count = doc.getLength();
+		int position = e.getOffset();
+		int length = e.getLength();
+		int old_count = insert ? count - length : count + length;
+		int deleted = insert ? 0 : length;
+		String inserted = "";
+		if (insert) {
+			try {
+				inserted = doc.getText(position, length);
+			} catch (BadLocationException ex) {
+				position = -1;
+			}
+		}
+
+		if (SwingUtilities.isEventDispatchThread()) {
+			segmentation = null;
+			applyChange(position, deleted, inserted, old_count, count);
+		} else {
+			text_caches_stale = true;
+			if (_mirror != 0)
+				AtkWrapper.textMirrorChanged(this, position, deleted, inserted, count);
+		}
+		emitDocumentChange(doc, position, length, insert);
+	}
+
+	/*
+	 * Send the edit with its exact range in characters, as counted by the
+	 * index of the Document, which the write lock held here protects.
+	 */
+	private void emitDocumentChange (Document doc, int position, int length, boolean insert) {
+		AccessibleContext ac = _ac.get();
+		if (ac == null)
+			return;
+
+		AtkTextSurrogateIndex index = document_surrogates;
+		if (position < 0 || index == null || doc != document ||
+				index.getLength() != (insert ? doc.getLength() - length : doc.getLength() + length)) {
+			document_surrogates = getDocumentSurrogates(doc);
+			Object[] args = new Object[3];
+			args[0] = 0;
+			args[1] = document_surrogates.getCharCount();
+			args[2] = _text_serial;
+			AtkWrapper.emitSignal(ac, AtkSignal.TEXT_PROPERTY_CHANGED, args);
+			return;
+		}
+
+		int char_position, char_length;
+		if (insert) {
+			try {
+				index.insert(position, doc.getText(position, length));
+			} catch (BadLocationException ex) {
+				emitDocumentChange(doc, -1, length, insert);
+				return;
+			}
+			joinDocumentSurrogates(index, doc, position);
+			joinDocumentSurrogates(index, doc, position + length);
+			char_position = index.toChars(position);
+			char_length = index.toCharsEnd(position + length) - char_position;
+		} else {
+			char_position = index.toChars(position);
+			char_length = index.toCharsEnd(position + length) - char_position;
+			index.delete(position, length);
+			joinDocumentSurrogates(index, doc, position);
+		}
+		if (char_length <= 0)
+			return;
+
+		Object[] args = new Object[4];
+		args[0] = char_position;
+		args[1] = char_length;
+		args[2] = index.getCharCount();
+		args[3] = _text_serial;
+		AtkWrapper.emitSignal(ac, insert ? AtkSignal.TEXT_PROPERTY_CHANGED_INSERT :
+		                                   AtkSignal.TEXT_PROPERTY_CHANGED_DELETE, args);
+	}
+
+	private static AtkTextSurrogateIndex getDocumentSurrogates (Document doc) {
+		String s = getDocumentText(doc, 0, doc.getLength());
+		return new AtkTextSurrogateIndex(s != null ? s : "");
+	}
+
+	private static void joinDocumentSurrogates (AtkTextSurrogateIndex index, Document doc, int offset) {
+		if (offset <= 0 || offset >= index.getLength())
+			return;
+		try {
+			String s = doc.getText(offset - 1, 2);
+			index.join(offset, s.charAt(0), s.charAt(1));
+		} catch (BadLocationException ex) {
+		}
+	}
+
+	/*
+	 * Apply a deletion followed by an insertion at the same position to the
+	 * line index, the surrogate index and the native mirror.  A position of
+	 * -1 means we couldn't tell what changed.
+	 */
+	private void applyChange (int position, int deleted, String inserted,
+			int old_count, int count) {
+		checkTextCaches();
+		if (position >= 0 && old_count >= 0 && old_count - deleted + inserted.length() != count)
+			position = -1;
+		if (position >= 0 && deleted == 0 && inserted.length() == 0)
+			return;
+
+		AtkTextLineIndex lines = line_index;
+		if (lines != null) {
+			if (position >= 0 && lines.getLength() == old_count) {
+				lines.delete(position, deleted);
+				lines.insert(position, inserted);
+			}
+			if (lines.getLength() != count)
+				line_index = null;
+		}
+
+		AtkTextSurrogateIndex index = surrogates;
+		if (index != null) {
+			if (position >= 0 && index.getLength() == old_count) {
+				index.delete(position, deleted);
+				index.insert(position, inserted);
+				joinSurrogates(index, position);
+				joinSurrogates(index, position + inserted.length());
+			}
+			if (position < 0 || index.getLength() != count)
+				surrogates = null;
+		}
+
+		if (_mirror != 0)
+			AtkWrapper.textMirrorChanged(this, position, deleted, inserted, count);
+	}
+
+	/*
+	 * Labels and buttons only send VISIBLE_DATA or NAME when their text is
+	 * set, and the new text may have the same length as the old one, so
+	 * nothing kept about the text can be trusted any more.
+	 */
+	private void textReplaced () {
+		text_caches_stale = false;
+		line_index = null;
+		segmentation = null;
+		surrogates = null;
+		_attributes_serial++;
+		_text_serial++;
+		_caret_serial++;
+
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return;
+		int count = acc_text.getCharCount();
+		text_length = count;
+
+		if (_mirror != 0)
+			AtkWrapper.textMirrorChanged(this, -1, 0, "", count);
+	}
+
+	private static int getSequenceLength (Object value) {
+		if (!(value instanceof AccessibleTextSequence))
+			return 0;
+		AccessibleTextSequence seq = (AccessibleTextSequence)value;
+		return seq.text != null ? seq.text.length() : seq.endIndex - seq.startIndex;
+	}
+
+	/* Record a surrogate pair across offset, once the text has changed */
+	private void joinSurrogates (AtkTextSurrogateIndex index, int offset) {
+		if (offset <= 0 || offset >= index.getLength())
+			return;
+		String s = getTextUnits(offset - 1, offset + 1);
+		if (s != null && s.length() == 2)
+			index.join(offset, s.charAt(0), s.charAt(1));
+	}
+
+	/* Checksum of the whole text, for checking the native mirror */
+	public int get_text_hash () {
+		String str = get_text(0, -1);
+		if (str == null)
+			return 0;
+		return str.hashCode();
+	}
+
+	/* Drop what is kept about a text which changed off the Swing thread */
+	private void checkTextCaches () {
+		if (text_caches_stale) {
+			text_caches_stale = false;
+			line_index = null;
+			segmentation = null;
+			surrogates = null;
+		}
+	}
+
+	private AtkTextLineIndex getLineIndex (int char_count) {
+		checkTextCaches();
+		if (line_index == null || line_index.getLength() != char_count) {
+			String s = getTextUnits(0, char_count);
+			line_index = new AtkTextLineIndex(s != null ? s : "");
+		}
+		return line_index;
+	}
+
+	/* Only call from the Swing thread */
+	AtkTextSurrogateIndex getSurrogateIndex (AccessibleText acc_text) {
+		if (!listened) {
+			AccessibleContext ac = _ac.get();
+			AtkText atk_text = ac != null ? getInstance(ac) : null;
+			if (atk_text != null && atk_text != this)
+				return atk_text.getSurrogateIndex(acc_text);
+			String s = getTextUnits(acc_text, 0, acc_text.getCharCount());
+			return new AtkTextSurrogateIndex(s != null ? s : "");
+		}
+
+		checkTextCaches();
+		int count = acc_text.getCharCount();
+		if (surrogates == null || surrogates.getLength() != count) {
+			String s = getTextUnits(acc_text, 0, count);
+			surrogates = new AtkTextSurrogateIndex(s != null ? s : "");
+		}
+		return surrogates;
+	}
+
+	/* Character offset to UTF-16 offset, for AtkEditableText */
+	int toUnits (int offset) {
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return offset;
+		return AtkUtil.invokeInSwing ( () -> {
+			return getSurrogateIndex(acc_text).toUnits(offset);
+		}, offset);
+	}
+
+	private static AtkText getInstance (AccessibleContext ac) {
+		WeakReference<AtkText> ref = instances.get(ac);
+		return ref != null ? ref.get() : null;
+	}
+
+	/*
+	 * State sent along with the events of ac, so that jawtext.c can cache it
+	 * until the serial changes.  -1 if ac has no AtkText.
+	 */
+	public static int getCaretSerial (AccessibleContext ac) {
+		AtkText atk_text = getInstance(ac);
+		return atk_text != null ? atk_text._caret_serial : -1;
+	}
+
+	public static int getTextSerial (AccessibleContext ac) {
+		AtkText atk_text = getInstance(ac);
+		return atk_text != null ? atk_text._text_serial : -1;
 	}
 
-	private int getNextWordStart (int offset, String str) {
-		BreakIterator words = BreakIterator.getWordInstance();
-		words.setText(str);
+	/* Whether the last AccessibleTextSequence change of ac was already notified */
+	public static boolean isChangeSeen (AccessibleContext ac) {
+		AtkText atk_text = getInstance(ac);
+		return atk_text != null && atk_text.change_seen;
+	}
+
+	/* Whether the edits of ac are sent by its DocumentListener */
+	public static boolean isDocumentListened (AccessibleContext ac) {
+		AtkText atk_text = getInstance(ac);
+		return atk_text != null && atk_text._document_listener != null;
+	}
+
+	public static int getCharCount (AccessibleContext ac) {
+		AtkText atk_text = getInstance(ac);
+		return atk_text != null ? atk_text.get_character_count() : -1;
+	}
+
+	/*
+	 * Character offset of a UTF-16 offset found in an event of ac.  The
+	 * listener of the AtkText is registered before the one of AtkWrapper,
+	 * so the index has already seen the change by then.
+	 */
+	public static int getCharOffset (AccessibleContext ac, int offset) {
+		AtkText atk_text = getInstance(ac);
+		if (atk_text == null)
+			return offset;
+		AccessibleText acc_text = atk_text._acc_text.get();
+		if (acc_text == null)
+			return offset;
+
+		return AtkUtil.invokeInSwing ( () -> {
+			return atk_text.getSurrogateIndex(acc_text).toChars(offset);
+		}, offset);
+	}
+
+	/* getTextAtOffset() with character offsets, widened to whole characters */
+	private StringSequence getTextAtChar (AccessibleText acc_text, int offset,
+			int boundary_type) {
+		AtkTextSurrogateIndex index = getSurrogateIndex(acc_text);
+		if (offset < 0 || offset > index.getCharCount())
+			return null;
+
+		return toCharRange(acc_text, index,
+				getTextAtOffset(acc_text, index.toUnits(offset), boundary_type));
+	}
+
+	/* seq with character offsets, widened to whole characters */
+	private StringSequence toCharRange (AccessibleText acc_text, AtkTextSurrogateIndex index,
+			StringSequence seq) {
+		if (seq == null)
+			return null;
+		int start = index.toChars(seq.start_offset);
+		int end = index.toCharsEnd(seq.end_offset);
+		int start_units = index.toUnits(start);
+		int end_units = index.toUnits(end);
+		if (start_units != seq.start_offset || end_units != seq.end_offset) {
+			seq.str = getTextUnits(acc_text, start_units, end_units);
+			if (seq.str == null)
+				return null;
+		}
+		seq.start_offset = start;
+		seq.end_offset = end;
+		return seq;
+	}
+
+	/*
+	 * Use the segmentation of AccessibleExtendedText when there is one, and
+	 * only compute the boundaries ourselves when it can't give an answer.
+	 */
+	private StringSequence getTextAtOffset (AccessibleText acc_text, int offset,
+			int boundary_type) {
+		if (acc_text instanceof AccessibleExtendedText) {
+			int char_count = acc_text.getCharCount();
+			AtkTextBoundaryAdapter adapter = new AtkTextBoundaryAdapter(
+					(AccessibleExtendedText)acc_text, char_count);
+			int[] range = adapter.getRangeAtOffset(offset, boundary_type);
+			if (range != null) {
+				String str = getTextUnits(acc_text, range[0], range[1]);
+				if (str != null)
+					return new StringSequence(str, range[0], range[1]);
+			}
+		}
+		return private_get_text_at_offset(offset, boundary_type);
+	}
+
+	/*
+	 * Word and sentence boundaries are computed on a window of the text
+	 * around the offset.  A result which reaches too close to an edge of the
+	 * window that is not an edge of the text may have been cut short by the
+	 * window, so the window is then widened and the query tried again.
+	 */
+	private StringSequence getSegmentAtOffset (int offset, int char_count,
+			int boundary_type) {
+		checkTextCaches();
+		AtkTextSegmentation seg = segmentation;
+		if (seg != null && !seg.covers(offset - SEGMENT_MARGIN,
+				offset + SEGMENT_MARGIN, char_count))
+			seg = null;
+
+		int span = SEGMENT_WINDOW;
+		while (true) {
+			if (seg == null) {
+				int window_start = Math.max(0, offset - span);
+				int window_end = Math.min(char_count, offset + span);
+				String text = getTextUnits(window_start, window_end);
+				if (text == null)
+					return null;
+				seg = new AtkTextSegmentation(text, window_start, char_count);
+				segmentation = seg;
+			}
+
+			String s = seg.getText();
+			int local_offset = offset - seg.getStart();
+			int start, end;
+			switch (boundary_type) {
+				case AtkTextBoundary.WORD_START :
+					start = getPreviousWordStart(local_offset+1, seg);
+					end = getNextWordStart(local_offset, seg);
+					break;
+				case AtkTextBoundary.WORD_END :
+					start = getPreviousWordEnd(local_offset, seg);
+					end = getNextWordEnd(local_offset-1, seg);
+					break;
+				case AtkTextBoundary.SENTENCE_START :
+					start = getPreviousSentenceStart(local_offset+1, seg);
+					end = getNextSentenceStart(local_offset, seg);
+					break;
+				case AtkTextBoundary.SENTENCE_END :
+					start = getPreviousSentenceEnd(local_offset, seg);
+					end = getNextSentenceEnd(local_offset-1, seg);
+					break;
+				default :
+					return null;
+			}
+			if (start == BreakIterator.DONE)
+				start = 0;
+			if (end == BreakIterator.DONE)
+				end = s.length();
+
+			if (seg.isWholeText() ||
+					((seg.getStart() == 0 || start >= SEGMENT_MARGIN) &&
+					 (seg.getEnd() == char_count || end <= s.length() - SEGMENT_MARGIN)))
+				return new StringSequence(s.substring(start, end),
+						seg.getStart() + start, seg.getStart() + end);
+
+			span *= 2;
+			seg = null;
+		}
+	}
+
+	private int getNextWordStart (int offset, AtkTextSegmentation seg) {
+		BreakIterator words = seg.getWordIterator();
+		String str = seg.getText();
 		int start = words.following(offset);
 		int end = words.next();
 
@@ -398,11 +1343,10 @@ public class AtkText {
 		return BreakIterator.DONE;
 	}
 
-	private int getNextWordEnd (int offset, String str) {
-		int start = getNextWordStart(offset, str);
+	private int getNextWordEnd (int offset, AtkTextSegmentation seg) {
+		int start = getNextWordStart(offset, seg);
 
-		BreakIterator words = BreakIterator.getWordInstance();
-		words.setText(str);
+		BreakIterator words = seg.getWordIterator();
 		int next = words.following(offset);
 
 		if (start == next) {
@@ -412,9 +1356,9 @@ public class AtkText {
 		}
 	}
 
-	private int getPreviousWordStart (int offset, String str) {
-		BreakIterator words = BreakIterator.getWordInstance();
-		words.setText(str);
+	private int getPreviousWordStart (int offset, AtkTextSegmentation seg) {
+		BreakIterator words = seg.getWordIterator();
+		String str = seg.getText();
 		int start = words.preceding(offset);
 		int end = words.next();
 
@@ -432,11 +1376,10 @@ public class AtkText {
 		return BreakIterator.DONE;
 	}
 
-	private int getPreviousWordEnd (int offset, String str) {
-		int start = getPreviousWordStart(offset, str);
+	private int getPreviousWordEnd (int offset, AtkTextSegmentation seg) {
+		int start = getPreviousWordStart(offset, seg);
 
-		BreakIterator words = BreakIterator.getWordInstance();
-		words.setText(str);
+		BreakIterator words = seg.getWordIterator();
 		int pre = words.preceding(offset);
 
 		if (start == pre) {
@@ -446,16 +1389,16 @@ public class AtkText {
 		}
 	}
 
-	private int getNextSentenceStart (int offset, String str) {
-		BreakIterator sentences = BreakIterator.getSentenceInstance();
-		sentences.setText(str);
+	private int getNextSentenceStart (int offset, AtkTextSegmentation seg) {
+		BreakIterator sentences = seg.getSentenceIterator();
 		int start = sentences.following(offset);
 
 		return start;
 	}
 
-	private int getNextSentenceEnd (int offset, String str) {
-		int start = getNextSentenceStart(offset, str);
+	private int getNextSentenceEnd (int offset, AtkTextSegmentation seg) {
+		String str = seg.getText();
+		int start = getNextSentenceStart(offset, seg);
 		if (start == BreakIterator.DONE) {
 			return str.length();
 		}
@@ -467,7 +1410,7 @@ public class AtkText {
 
 		index ++;
 		if (index < offset) {
-			start = getNextSentenceStart(start, str);
+			start = getNextSentenceStart(start, seg);
 			if (start == BreakIterator.DONE) {
 				return str.length();
 			}
@@ -483,77 +1426,38 @@ public class AtkText {
 		return index;
 	}
 
-	private int getPreviousSentenceStart (int offset, String str) {
-		BreakIterator sentences = BreakIterator.getSentenceInstance();
-		sentences.setText(str);
+	private int getPreviousSentenceStart (int offset, AtkTextSegmentation seg) {
+		BreakIterator sentences = seg.getSentenceIterator();
 		int start = sentences.preceding(offset);
 
 		return start;
 	}
 
-	private int getPreviousSentenceEnd (int offset, String str) {
-		int start = getPreviousSentenceStart(offset, str);
+	private int getPreviousSentenceEnd (int offset, AtkTextSegmentation seg) {
+		int start = getPreviousSentenceStart(offset, seg);
 		if (start == BreakIterator.DONE) {
 			return 0;
 		}
 
-		int end = getNextSentenceEnd(start, str);
+		int end = getNextSentenceEnd(start, seg);
 		if (offset < end) {
-			start = getPreviousSentenceStart(start, str);
+			start = getPreviousSentenceStart(start, seg);
 			if (start == BreakIterator.DONE) {
 				return 0;
 			}
 
-			end = getNextSentenceEnd(start, str);
+			end = getNextSentenceEnd(start, seg);
 		}
 
 		return end;
 	}
 
-	private int getNextLineStart (int offset, String str) {
-		int max = str.length();
-		while (offset < max) {
-			if (str.charAt(offset) == '\n')
-				return offset+1;
-			offset += 1;
-		}
-		return offset;
-	}
-
-	private int getPreviousLineStart (int offset, String str) {
-		offset -= 2;
-		while (offset >= 0) {
-			if (str.charAt(offset) == '\n')
-				return offset+1;
-			offset -= 1;
-		}
-		return 0;
-	}
-
-	private int getNextLineEnd (int offset, String str) {
-		int max = str.length();
-		offset += 1;
-		while (offset < max) {
-			if (str.charAt(offset) == '\n')
-				return offset;
-			offset += 1;
-		}
-		return offset;
-	}
-
-	private int getPreviousLineEnd (int offset, String str) {
-		offset -= 1;
-		while (offset >= 0) {
-			if (str.charAt(offset) == '\n')
-				return offset;
-			offset -= 1;
-		}
-		return 0;
-	}
-
 	private StringSequence private_get_text_at_offset (int offset,
 			int boundary_type) {
-		int char_count = get_character_count();
+		AccessibleText acc_text = _acc_text.get();
+		if (acc_text == null)
+			return null;
+		int char_count = acc_text.getCharCount();
 		if (offset < 0 || offset > char_count) {
 			return null;
 		}
@@ -563,104 +1467,42 @@ public class AtkText {
 			{
 				if (offset == char_count)
 					return null;
-				String str = get_text(offset, offset+1);
+				String str = getTextUnits(offset, offset+1);
 				return new StringSequence(str, offset, offset+1);
 			}
 			case AtkTextBoundary.WORD_START :
-			{
-				if (offset == char_count)
-					return new StringSequence("", char_count, char_count);
-
-				String s = get_text(0, char_count);
-				int start = getPreviousWordStart(offset+1, s);
-				if (start == BreakIterator.DONE) {
-					start = 0;
-				}
-
-				int end = getNextWordStart(offset, s);
-				if (end == BreakIterator.DONE) {
-					end = s.length();
-				}
-
-				String str = get_text(start, end);
-				return new StringSequence(str, start, end);
-			}
-			case AtkTextBoundary.WORD_END :
-			{
-				if (offset == 0)
-					return new StringSequence("", 0, 0);
-
-				String s = get_text(0, char_count);
-				int start = getPreviousWordEnd(offset, s);
-				if (start == BreakIterator.DONE) {
-					start = 0;
-				}
-
-				int end = getNextWordEnd(offset-1, s);
-				if (end == BreakIterator.DONE) {
-					end = s.length();
-				}
-
-				String str = get_text(start, end);
-				return new StringSequence(str, start, end);
-			}
 			case AtkTextBoundary.SENTENCE_START :
 			{
 				if (offset == char_count)
 					return new StringSequence("", char_count, char_count);
-
-				String s = get_text(0, char_count);
-				int start = getPreviousSentenceStart(offset+1, s);
-				if (start == BreakIterator.DONE) {
-					start = 0;
-				}
-
-				int end = getNextSentenceStart(offset, s);
-				if (end == BreakIterator.DONE) {
-					end = s.length();
-				}
-
-				String str = get_text(start, end);
-				return new StringSequence(str, start, end);
+				return getSegmentAtOffset(offset, char_count, boundary_type);
 			}
+			case AtkTextBoundary.WORD_END :
 			case AtkTextBoundary.SENTENCE_END :
 			{
 				if (offset == 0)
 					return new StringSequence("", 0, 0);
-
-				String s = get_text(0, char_count);
-				int start = getPreviousSentenceEnd(offset, s);
-				if (start == BreakIterator.DONE) {
-					start = 0;
-				}
-
-				int end = getNextSentenceEnd(offset-1, s);
-				if (end == BreakIterator.DONE) {
-					end = s.length();
-				}
-
-				String str = get_text(start, end);
-				return new StringSequence(str, start, end);
+				return getSegmentAtOffset(offset, char_count, boundary_type);
 			}
 			case AtkTextBoundary.LINE_START :
 			{
 				if (offset == char_count)
 					return new StringSequence("", char_count, char_count);
 
-				String s = get_text(0, char_count);
-				int start = getPreviousLineStart(offset+1, s);
-				int end = getNextLineStart(offset, s);
+				AtkTextLineIndex lines = getLineIndex(char_count);
+				int start = lines.getPreviousLineStart(offset+1);
+				int end = lines.getNextLineStart(offset);
 
-				String str = get_text(start, end);
+				String str = getTextUnits(start, end);
 				return new StringSequence(str, start, end);
 			}
 			case AtkTextBoundary.LINE_END :
 			{
-				String s = get_text(0, char_count);
-				int start = getPreviousLineEnd(offset, s);
-				int end = getNextLineEnd(offset-1, s);
+				AtkTextLineIndex lines = getLineIndex(char_count);
+				int start = lines.getPreviousLineEnd(offset);
+				int end = lines.getNextLineEnd(offset-1);
 
-				String str = get_text(start, end);
+				String str = getTextUnits(start, end);
 				return new StringSequence(str, start, end);
 			}
 			default :
@@ -0,0 +1,197 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+import java.awt.Color;
+import java.awt.Font;
+import java.util.ArrayList;
+import javax.accessibility.*;
+import javax.swing.text.AttributeSet;
+import javax.swing.text.Document;
+import javax.swing.text.Element;
+import javax.swing.text.StyleConstants;
+import javax.swing.text.StyledDocument;
+
+/*
+ * Converts Swing text attributes into ATK text attributes.
+ *
+ * An attribute set is passed to jawtext.c as one string of "name:value"
+ * lines, using the names of atk_text_attribute_get_name().  Equal sets
+ * give equal strings, which jawtext.c uses to share them between runs.
+ * It must be used from the Swing thread.
+ */
+class AtkTextAttributes {
+
+	/* Runs [ends[i-1], ends[i]) with their attributes, covering the whole text */
+	public static class Runs {
+		public int[] ends;
+		public String[] attributes;
+
+		public Runs (int[] ends, String[] attributes) {
+			this.ends = ends;
+			this.attributes = attributes;
+		}
+	}
+
+	private int[] ends = new int[16];
+	private String[] attributes = new String[16];
+	private int n_runs = 0;
+
+	private void addRun (int end, String str) {
+		if (n_runs > 0 && attributes[n_runs-1].equals(str)) {
+			ends[n_runs-1] = end;
+			return;
+		}
+		if (n_runs == ends.length) {
+			int[] grown_ends = new int[n_runs * 2];
+			String[] grown_attributes = new String[n_runs * 2];
+			System.arraycopy(ends, 0, grown_ends, 0, n_runs);
+			System.arraycopy(attributes, 0, grown_attributes, 0, n_runs);
+			ends = grown_ends;
+			attributes = grown_attributes;
+		}
+		ends[n_runs] = end;
+		attributes[n_runs] = str;
+		n_runs++;
+	}
+
+	private Runs toRuns () {
+		int[] run_ends = new int[n_runs];
+		String[] run_attributes = new String[n_runs];
+		System.arraycopy(ends, 0, run_ends, 0, n_runs);
+		System.arraycopy(attributes, 0, run_attributes, 0, n_runs);
+		return new Runs(run_ends, run_attributes);
+	}
+
+	/*
+	 * Walk the character elements of a StyledDocument, or else ask the
+	 * AccessibleText character by character.
+	 */
+	public static Runs getRuns (AccessibleText acc_text, Document doc) {
+		AtkTextAttributes runs = new AtkTextAttributes();
+		int char_count = acc_text.getCharCount();
+
+		if (doc instanceof StyledDocument && doc.getLength() == char_count) {
+			StyledDocument styled_doc = (StyledDocument)doc;
+			int offset = 0;
+			while (offset < char_count) {
+				Element element = styled_doc.getCharacterElement(offset);
+				int end = Math.min(element.getEndOffset(), char_count);
+				if (end <= offset)
+					break;
+				runs.addRun(end, toString(element.getAttributes()));
+				offset = end;
+			}
+			if (offset == char_count)
+				return runs.toRuns();
+			runs.n_runs = 0;
+		}
+
+		AttributeSet last = null;
+		String str = "";
+		for (int i = 0; i < char_count; i++) {
+			AttributeSet as = acc_text.getCharacterAttribute(i);
+			if (i == 0 || as != last && (as == null || last == null || !as.isEqual(last)))
+				str = toString(as);
+			last = as;
+			runs.addRun(i + 1, str);
+		}
+		return runs.toRuns();
+	}
+
+	/* What the text looks like where no attribute is set */
+	public static String getDefaults (AccessibleContext ac) {
+		AccessibleComponent acc_component = ac.getAccessibleComponent();
+		if (acc_component == null)
+			return "";
+
+		StringBuilder buf = new StringBuilder();
+		Font font = acc_component.getFont();
+		if (font != null) {
+			append(buf, "family-name", font.getFamily());
+			append(buf, "size", Integer.toString(font.getSize()));
+			append(buf, "weight", font.isBold() ? "700" : "400");
+			append(buf, "style", font.isItalic() ? "italic" : "normal");
+		}
+		append(buf, "fg-color", acc_component.getForeground());
+		append(buf, "bg-color", acc_component.getBackground());
+		return buf.toString();
+	}
+
+	public static String toString (AttributeSet as) {
+		if (as == null)
+			return "";
+
+		StringBuilder buf = new StringBuilder();
+		Object o;
+		if ((o = as.getAttribute(StyleConstants.FontFamily)) != null)
+			append(buf, "family-name", o.toString());
+		if ((o = as.getAttribute(StyleConstants.FontSize)) instanceof Number)
+			append(buf, "size", Integer.toString(((Number)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.Bold)) instanceof Boolean)
+			append(buf, "weight", ((Boolean)o).booleanValue() ? "700" : "400");
+		if ((o = as.getAttribute(StyleConstants.Italic)) instanceof Boolean)
+			append(buf, "style", ((Boolean)o).booleanValue() ? "italic" : "normal");
+		if ((o = as.getAttribute(StyleConstants.Underline)) instanceof Boolean)
+			append(buf, "underline", ((Boolean)o).booleanValue() ? "single" : "none");
+		if ((o = as.getAttribute(StyleConstants.StrikeThrough)) instanceof Boolean)
+			append(buf, "strikethrough", o.toString());
+		if ((o = as.getAttribute(StyleConstants.Foreground)) instanceof Color)
+			append(buf, "fg-color", (Color)o);
+		if ((o = as.getAttribute(StyleConstants.Background)) instanceof Color)
+			append(buf, "bg-color", (Color)o);
+		if ((o = as.getAttribute(StyleConstants.Alignment)) instanceof Integer)
+			append(buf, "justification", getJustification(((Integer)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.LeftIndent)) instanceof Number)
+			append(buf, "left-margin", Integer.toString(((Number)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.RightIndent)) instanceof Number)
+			append(buf, "right-margin", Integer.toString(((Number)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.FirstLineIndent)) instanceof Number)
+			append(buf, "indent", Integer.toString(((Number)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.SpaceAbove)) instanceof Number)
+			append(buf, "pixels-above-lines", Integer.toString(((Number)o).intValue()));
+		if ((o = as.getAttribute(StyleConstants.SpaceBelow)) instanceof Number)
+			append(buf, "pixels-below-lines", Integer.toString(((Number)o).intValue()));
+		return buf.toString();
+	}
+
+	private static String getJustification (int alignment) {
+		switch (alignment) {
+			case StyleConstants.ALIGN_RIGHT :
+				return "right";
+			case StyleConstants.ALIGN_CENTER :
+				return "center";
+			case StyleConstants.ALIGN_JUSTIFIED :
+				return "fill";
+			default :
+				return "left";
+		}
+	}
+
+	private static void append (StringBuilder buf, String name, Color color) {
+		if (color != null)
+			append(buf, name, color.getRed() + "," + color.getGreen() + "," + color.getBlue());
+	}
+
+	private static void append (StringBuilder buf, String name, String value) {
+		if (value.indexOf('\n') != -1)
+			return;
+		buf.append(name).append(':').append(value).append('\n');
+	}
+}
@@ -0,0 +1,264 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+import javax.accessibility.*;
+import java.text.BreakIterator;
+
+/*
+ * Maps the ATK START/END text boundaries onto the sequences returned by
+ * AccessibleExtendedText.
+ *
+ * Swing hands out units: characters, words (including the runs of spaces
+ * and punctuation between them), sentences and lines.  A START range goes
+ * from the start of the unit at the offset to the start of the next one,
+ * with words only counting when they hold a letter.  An END range goes
+ * from the end of the previous unit to the end of the unit at the offset,
+ * where the end of a unit leaves out its trailing spaces (sentences), its
+ * trailing newline (lines) or what follows the word itself (words).
+ *
+ * Every method returns null when Swing doesn't give a usable answer, in
+ * which case the caller falls back to computing the boundaries itself.
+ * It must be used from the Swing thread.
+ */
+class AtkTextBoundaryAdapter {
+
+	/* Text on either side of the offset first looked at for words */
+	private static final int WORD_WINDOW = 256;
+
+	private final AccessibleExtendedText acc_ext_text;
+	private final int char_count;
+
+	public AtkTextBoundaryAdapter (AccessibleExtendedText acc_ext_text, int char_count) {
+		this.acc_ext_text = acc_ext_text;
+		this.char_count = char_count;
+	}
+
+	public static int getPartTypeFromBoundary (int boundary_type) {
+		switch (boundary_type) {
+			case AtkTextBoundary.CHAR :
+				return AccessibleText.CHARACTER;
+			case AtkTextBoundary.WORD_START :
+			case AtkTextBoundary.WORD_END :
+				return AccessibleText.WORD;
+			case AtkTextBoundary.SENTENCE_START :
+			case AtkTextBoundary.SENTENCE_END :
+				return AccessibleText.SENTENCE;
+			case AtkTextBoundary.LINE_START :
+			case AtkTextBoundary.LINE_END :
+				return AccessibleExtendedText.LINE;
+			default :
+				return -1;
+		}
+	}
+
+	/* [start, end) of the boundary_type range at offset */
+	public int[] getRangeAtOffset (int offset, int boundary_type) {
+		int part = getPartTypeFromBoundary(boundary_type);
+		if (part == -1 || offset < 0 || offset > char_count)
+			return null;
+
+		int[] range;
+		switch (boundary_type) {
+			case AtkTextBoundary.CHAR :
+			{
+				if (offset == char_count)
+					return null;
+				AccessibleTextSequence seq = acc_ext_text.getTextSequenceAt(part, offset);
+				if (seq == null || seq.text == null)
+					return null;
+				range = new int[] { seq.startIndex, seq.startIndex + seq.text.length() };
+				break;
+			}
+			case AtkTextBoundary.WORD_START :
+			case AtkTextBoundary.SENTENCE_START :
+			case AtkTextBoundary.LINE_START :
+			{
+				if (offset == char_count)
+					return new int[] { char_count, char_count };
+				range = getUnitRange(part, offset);
+				break;
+			}
+			case AtkTextBoundary.WORD_END :
+			case AtkTextBoundary.SENTENCE_END :
+			{
+				if (offset == 0)
+					return new int[] { 0, 0 };
+				range = getEndRange(part, offset);
+				break;
+			}
+			case AtkTextBoundary.LINE_END :
+			{
+				range = getEndRange(part, offset);
+				break;
+			}
+			default :
+				return null;
+		}
+
+		if (range == null || range[0] < 0 || range[0] > range[1] || range[1] > char_count)
+			return null;
+		return range;
+	}
+
+	/* Unit at offset, from its start up to the start of the next unit */
+	private int[] getUnitRange (int part, int offset) {
+		if (part == AccessibleText.WORD)
+			return getWordRange(offset);
+
+		AccessibleTextSequence seq = acc_ext_text.getTextSequenceAt(part, offset);
+		if (seq == null || seq.startIndex > offset)
+			return null;
+		AccessibleTextSequence next = acc_ext_text.getTextSequenceAfter(part, offset);
+		int end = char_count;
+		if (next != null && next.startIndex > seq.startIndex)
+			end = next.startIndex;
+		if (end <= offset)
+			return null;
+		return new int[] { seq.startIndex, end };
+	}
+
+	/*
+	 * The words without a letter around offset are skipped on a window of
+	 * the text broken the way Swing breaks it, rather than one sequence
+	 * at a time.  The window is widened while the range reaches one of its
+	 * edges that is not an edge of the text.
+	 */
+	private int[] getWordRange (int offset) {
+		int span = WORD_WINDOW;
+		while (true) {
+			int window_start = Math.max(0, offset - span);
+			int window_end = Math.min(char_count, offset + span);
+			String text = acc_ext_text.getTextRange(window_start, window_end);
+			if (text == null || text.length() != window_end - window_start)
+				return null;
+			AtkTextSegmentation seg = new AtkTextSegmentation(text, window_start, char_count);
+			BreakIterator words = seg.getWordIterator();
+			int local_offset = offset - window_start;
+			int word_start = words.isBoundary(local_offset) ? local_offset : words.preceding(local_offset);
+
+			int start = -1;
+			for (int b = word_start; b != BreakIterator.DONE; b = words.preceding(b)) {
+				if (hasLetter(text, b, words.following(b))) {
+					start = b;
+					break;
+				}
+				if (b == 0)
+					break;
+			}
+			int end = -1;
+			for (int b = words.following(word_start); b != BreakIterator.DONE && b < text.length();
+					b = words.following(b)) {
+				int next = words.following(b);
+				if (hasLetter(text, b, next)) {
+					if (next < text.length() || window_end == char_count)
+						end = b;
+					break;
+				}
+			}
+
+			if ((start <= 0 && window_start > 0) || (end == -1 && window_end < char_count)) {
+				span *= 2;
+				continue;
+			}
+			start = (start > 0) ? window_start + start : 0;
+			end = (end != -1) ? window_start + end : char_count;
+			if (end <= offset)
+				return null;
+			return new int[] { start, end };
+		}
+	}
+
+	private int[] getEndRange (int part, int offset) {
+		if (char_count == 0)
+			return new int[] { 0, 0 };
+
+		int[] unit = getUnitRange(part, Math.min(offset, char_count - 1));
+		if (unit == null)
+			return null;
+		int end = getContentEnd(part, unit);
+
+		if (offset > end) {
+			if (unit[1] >= char_count)
+				return new int[] { end, char_count };
+			int[] next = getUnitRange(part, unit[1]);
+			if (next == null)
+				return null;
+			return new int[] { end, getContentEnd(part, next) };
+		}
+
+		if (unit[0] == 0)
+			return new int[] { 0, end };
+		int[] prev = getUnitRange(part, unit[0] - 1);
+		if (prev == null)
+			return null;
+		return new int[] { getContentEnd(part, prev), end };
+	}
+
+	/* Where the unit stops, leaving out what merely separates it from the next one */
+	private int getContentEnd (int part, int[] unit) {
+		switch (part) {
+			case AccessibleText.WORD :
+			{
+				AccessibleTextSequence seq = acc_ext_text.getTextSequenceAt(part, unit[0]);
+				if (seq == null || seq.text == null || !hasLetter(seq))
+					return unit[0];
+				return Math.min(seq.startIndex + seq.text.length(), unit[1]);
+			}
+			case AccessibleText.SENTENCE :
+			{
+				String str = acc_ext_text.getTextRange(unit[0], unit[1]);
+				if (str == null)
+					return unit[1];
+				int index = str.length();
+				while (index > 0 && Character.isWhitespace(str.charAt(index - 1)))
+					index--;
+				return unit[0] + index;
+			}
+			default :
+			{
+				if (unit[1] > unit[0]) {
+					String str = acc_ext_text.getTextRange(unit[1] - 1, unit[1]);
+					if (str != null && str.equals("\n"))
+						return unit[1] - 1;
+				}
+				return unit[1];
+			}
+		}
+	}
+
+	private static boolean hasLetter (AccessibleTextSequence seq) {
+		String str = seq.text;
+		if (str == null)
+			return false;
+		return hasLetter(str, 0, str.length());
+	}
+
+	private static boolean hasLetter (String str, int start, int end) {
+		if (end == BreakIterator.DONE)
+			end = str.length();
+		for (int i = start; i < end; ) {
+			int c = str.codePointAt(i);
+			if (Character.isLetter(c))
+				return true;
+			i += Character.charCount(c);
+		}
+		return false;
+	}
+}
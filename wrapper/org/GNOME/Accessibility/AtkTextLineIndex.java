@@ -0,0 +1,137 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+/*
+ * Sorted offsets of the '\n' characters of a text, so that line boundaries
+ * can be found with a binary search instead of scanning the whole text.
+ * The index is kept up to date with insert() and delete() as the text
+ * changes.  It is only ever used from the Swing thread.
+ */
+class AtkTextLineIndex {
+
+	private int[] newlines;
+	private int n_newlines;
+	private int length;
+
+	public AtkTextLineIndex (String text) {
+		newlines = new int[16];
+		n_newlines = 0;
+		length = 0;
+		insert(0, text);
+	}
+
+	public int getLength () {
+		return length;
+	}
+
+	/* Index of the first newline at or after offset, n_newlines if none */
+	private int search (int offset) {
+		int low = 0;
+		int high = n_newlines;
+		while (low < high) {
+			int mid = (low + high) >>> 1;
+			if (newlines[mid] < offset)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	/* Start of the line following the newline found at or after offset */
+	public int getNextLineStart (int offset) {
+		int i = search(offset);
+		if (i == n_newlines)
+			return length;
+		return newlines[i] + 1;
+	}
+
+	/* Start of the line following the last newline before offset-1 */
+	public int getPreviousLineStart (int offset) {
+		int i = search(offset - 1);
+		if (i == 0)
+			return 0;
+		return newlines[i - 1] + 1;
+	}
+
+	/* First newline after offset */
+	public int getNextLineEnd (int offset) {
+		int i = search(offset + 1);
+		if (i == n_newlines)
+			return length;
+		return newlines[i];
+	}
+
+	/* Last newline before offset */
+	public int getPreviousLineEnd (int offset) {
+		int i = search(offset);
+		if (i == 0)
+			return 0;
+		return newlines[i - 1];
+	}
+
+	public void insert (int offset, String text) {
+		int len = text.length();
+		if (len == 0)
+			return;
+
+		int i = search(offset);
+		int added = 0;
+		for (int j = 0; j < len; j++) {
+			if (text.charAt(j) == '\n')
+				added++;
+		}
+
+		if (n_newlines + added > newlines.length) {
+			int[] grown = new int[Math.max(newlines.length * 2, n_newlines + added)];
+			System.arraycopy(newlines, 0, grown, 0, n_newlines);
+			newlines = grown;
+		}
+
+		System.arraycopy(newlines, i, newlines, i + added, n_newlines - i);
+		for (int j = i + added; j < n_newlines + added; j++)
+			newlines[j] += len;
+
+		int k = i;
+		for (int j = 0; j < len; j++) {
+			if (text.charAt(j) == '\n')
+				newlines[k++] = offset + j;
+		}
+
+		n_newlines += added;
+		length += len;
+	}
+
+	public void delete (int offset, int len) {
+		if (len <= 0)
+			return;
+
+		int first = search(offset);
+		int last = search(offset + len);
+		int removed = last - first;
+
+		System.arraycopy(newlines, last, newlines, first, n_newlines - last);
+		n_newlines -= removed;
+		for (int j = first; j < n_newlines; j++)
+			newlines[j] -= len;
+
+		length -= len;
+	}
+}
@@ -0,0 +1,81 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+import java.text.BreakIterator;
+
+/*
+ * A window of a text together with the word and sentence BreakIterators
+ * set on it.  The iterators are only created when a query needs them, and
+ * the whole object is dropped as soon as the text changes.  It is only
+ * ever used from the Swing thread.
+ */
+class AtkTextSegmentation {
+
+	private final String text;
+	private final int start;
+	private final int char_count;
+	private BreakIterator words;
+	private BreakIterator sentences;
+
+	public AtkTextSegmentation (String text, int start, int char_count) {
+		this.text = text;
+		this.start = start;
+		this.char_count = char_count;
+	}
+
+	public String getText () {
+		return text;
+	}
+
+	public int getStart () {
+		return start;
+	}
+
+	public int getEnd () {
+		return start + text.length();
+	}
+
+	public boolean isWholeText () {
+		return start == 0 && getEnd() == char_count;
+	}
+
+	/* Whether the window holds [from, to] of a text of char_count characters */
+	public boolean covers (int from, int to, int char_count) {
+		if (this.char_count != char_count)
+			return false;
+		return start <= Math.max(from, 0) && getEnd() >= Math.min(to, char_count);
+	}
+
+	public BreakIterator getWordIterator () {
+		if (words == null) {
+			words = BreakIterator.getWordInstance();
+			words.setText(text);
+		}
+		return words;
+	}
+
+	public BreakIterator getSentenceIterator () {
+		if (sentences == null) {
+			sentences = BreakIterator.getSentenceInstance();
+			sentences.setText(text);
+		}
+		return sentences;
+	}
+}
@@ -0,0 +1,193 @@
+/*
+ * Java ATK Wrapper for GNOME
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+/*
+ * ATK offsets count characters, while AccessibleText offsets count UTF-16
+ * units, which differ by one for each surrogate pair before the offset.
+ * This keeps the sorted unit offsets of the high surrogate of every pair of
+ * a text, so that offsets are converted with a binary search.  The index is
+ * kept up to date with insert(), delete() and join() as the text changes.
+ * It is used from one thread at a time: the Swing thread, or whichever
+ * thread holds the lock of the Document it was made for.
+ */
+class AtkTextSurrogateIndex {
+
+	private int[] pairs;
+	private int n_pairs;
+	private int length;
+
+	public AtkTextSurrogateIndex (String text) {
+		pairs = new int[16];
+		n_pairs = 0;
+		length = 0;
+		insert(0, text);
+	}
+
+	/* Length of the text in UTF-16 units */
+	public int getLength () {
+		return length;
+	}
+
+	/* Length of the text in characters */
+	public int getCharCount () {
+		return length - n_pairs;
+	}
+
+	/* Index of the first pair starting at or after offset, n_pairs if none */
+	private int search (int offset) {
+		int low = 0;
+		int high = n_pairs;
+		while (low < high) {
+			int mid = (low + high) >>> 1;
+			if (pairs[mid] < offset)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	/*
+	 * Unit offset of character offset.  Offsets outside of the text stay
+	 * outside of it, so that callers still see them as invalid.
+	 */
+	public int toUnits (int char_offset) {
+		if (char_offset <= 0)
+			return char_offset;
+		if (char_offset >= getCharCount())
+			return char_offset + n_pairs;
+
+		/* Pair i is character pairs[i] - i, which grows with i */
+		int low = 0;
+		int high = n_pairs;
+		while (low < high) {
+			int mid = (low + high) >>> 1;
+			if (pairs[mid] - mid < char_offset)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return char_offset + low;
+	}
+
+	/* Character offset of unit offset, the middle of a pair counts as its start */
+	public int toChars (int offset) {
+		if (offset <= 0)
+			return offset;
+		if (offset >= length)
+			return offset - n_pairs;
+		return offset - search(offset);
+	}
+
+	/* Character offset of unit offset, the middle of a pair counts as its end */
+	public int toCharsEnd (int offset) {
+		int char_offset = toChars(offset);
+		if (offset > 0 && offset < length && isPairStart(offset - 1))
+			char_offset++;
+		return char_offset;
+	}
+
+	private boolean isPairStart (int offset) {
+		int i = search(offset);
+		return i < n_pairs && pairs[i] == offset;
+	}
+
+	private void grow (int n) {
+		if (n > pairs.length) {
+			int[] grown = new int[Math.max(pairs.length * 2, n)];
+			System.arraycopy(pairs, 0, grown, 0, n_pairs);
+			pairs = grown;
+		}
+	}
+
+	/*
+	 * Pairs formed across the edges of the inserted text are not seen here,
+	 * join() has to be called on both edges once the text is known.
+	 */
+	public void insert (int offset, String text) {
+		int len = text.length();
+		if (len == 0)
+			return;
+
+		/* A pair around offset is split by the insertion */
+		int i = search(offset - 1);
+		if (i < n_pairs && pairs[i] == offset - 1) {
+			System.arraycopy(pairs, i + 1, pairs, i, n_pairs - i - 1);
+			n_pairs--;
+		}
+
+		int added = 0;
+		for (int j = 0; j + 1 < len; j++) {
+			if (Character.isSurrogatePair(text.charAt(j), text.charAt(j + 1))) {
+				added++;
+				j++;
+			}
+		}
+
+		grow(n_pairs + added);
+		System.arraycopy(pairs, i, pairs, i + added, n_pairs - i);
+		for (int j = i + added; j < n_pairs + added; j++)
+			pairs[j] += len;
+
+		int k = i;
+		for (int j = 0; j + 1 < len; j++) {
+			if (Character.isSurrogatePair(text.charAt(j), text.charAt(j + 1))) {
+				pairs[k++] = offset + j;
+				j++;
+			}
+		}
+
+		n_pairs += added;
+		length += len;
+	}
+
+	/* Same as insert() about pairs formed across the edges */
+	public void delete (int offset, int len) {
+		if (len <= 0)
+			return;
+
+		/* Pairs with a unit in [offset, offset+len) */
+		int first = search(offset - 1);
+		int last = search(offset + len);
+		int removed = last - first;
+
+		System.arraycopy(pairs, last, pairs, first, n_pairs - last);
+		n_pairs -= removed;
+		for (int j = first; j < n_pairs; j++)
+			pairs[j] -= len;
+
+		length -= len;
+	}
+
+	/* Record the pair made of units offset-1 and offset, given as high and low */
+	public void join (int offset, char high, char low) {
+		if (offset <= 0 || offset >= length || !Character.isSurrogatePair(high, low))
+			return;
+
+		int i = search(offset - 1);
+		if (i < n_pairs && pairs[i] == offset - 1)
+			return;
+
+		grow(n_pairs + 1);
+		System.arraycopy(pairs, i, pairs, i + 1, n_pairs - i);
+		pairs[i] = offset - 1;
+		n_pairs++;
+	}
+}
@@ -25,6 +25,7 @@
  */
 
 package org.GNOME.Accessibility;
+import javax.accessibility.*;
 import javax.swing.*;
 import java.util.concurrent.*;
 
@@ -89,4 +90,29 @@ public class AtkUtil{
         SwingUtilities.invokeLater(function);
     }
 
+    /**
+    * getAccessible:
+    *   Finds the Accessible object (usually the Component) an
+    *   AccessibleContext belongs to, by asking its parent for the
+    *   child at its index. It must be called from the EDT.
+    *
+    * @param ac The AccessibleContext
+    * @return The Accessible owning ac, or null if it can't be found
+    */
+    public static Accessible getAccessible (AccessibleContext ac){
+        Accessible parent = ac.getAccessibleParent();
+        if (parent == null)
+          return null;
+        AccessibleContext parent_ac = parent.getAccessibleContext();
+        if (parent_ac == null)
+          return null;
+        int index = ac.getAccessibleIndexInParent();
+        if (index < 0)
+          return null;
+        Accessible child = parent_ac.getAccessibleChild(index);
+        if (child == null || child.getAccessibleContext() != ac)
+          return null;
+        return child;
+    }
+
 }